@@ -26,6 +26,7 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -101,14 +102,38 @@ static void uart_print_first_pixels(void) {
 }
 
 // Q1: Histogram hesaplama
+// Ardışık 4 piksel 4 ayrı sayaç bankasına yazılır (bank 0 = hist): aynı
+// değerli komşular aynı sayacı arka arkaya artırıp birbirini beklemez.
+// Her banka bir parçada en fazla 65535 sayar, parça sonunda hist'e eklenir.
+static uint16_t hist_bank[3][256];
+
 static void compute_histogram(const uint8_t* img, int w, int h, uint32_t hist[256]) {
+  const uint8_t* p = img;
+  size_t n = (size_t)w * (size_t)h;
+
   for (int i = 0; i < 256; ++i) hist[i] = 0;
 
-  for (int y = 0; y < h; ++y) {
-    for (int x = 0; x < w; ++x) {
-      uint8_t p = img[y * w + x];
-      hist[p]++;
+  while (n > 0) {
+    size_t chunk = (n > 4u * 65535u) ? 4u * 65535u : n;
+    size_t i = 0;
+
+    for (int b = 0; b < 3; ++b) {
+      for (int v = 0; v < 256; ++v) hist_bank[b][v] = 0;
+    }
+
+    for (; i + 4 <= chunk; i += 4) {
+      hist[p[i]]++;
+      hist_bank[0][p[i + 1]]++;
+      hist_bank[1][p[i + 2]]++;
+      hist_bank[2][p[i + 3]]++;
+    }
+    for (; i < chunk; ++i) hist[p[i]]++;
+
+    for (int v = 0; v < 256; ++v) {
+      hist[v] += (uint32_t)hist_bank[0][v] + hist_bank[1][v] + hist_bank[2][v];
     }
+    p += chunk;
+    n -= chunk;
   }
 }
 
@@ -135,6 +160,94 @@ static void build_equalization_lut(const uint32_t hist[256], int total,
   }
 }
 
+// Q3: x / 9 yerine (x * LP_RECIP) >> LP_SHIFT; 0 <= x <= 9 * 255 için tam
+#define LP_SHIFT 16
+#define LP_RECIP ((1u << LP_SHIFT) / 9u + 1u)
+
+// Q3: 3x3 low-pass, yalnızca 3 satırlık pencereden. Sütun toplamları bir kez
+// alınır, yatay toplam kayarak güncellenir (piksel başına 9 yerine ~3 toplama)
+// ve bölme çarpma + kaydırma ile yapılır. out[1..IMG_W-2] geçerlidir.
+static void lowpass3x3_row(const uint8_t* top, const uint8_t* mid,
+                           const uint8_t* bot, uint8_t* out) {
+  uint16_t col[IMG_W];
+  for (int x = 0; x < IMG_W; ++x) {
+    col[x] = (uint16_t)(top[x] + mid[x] + bot[x]);
+  }
+
+  uint32_t sum = (uint32_t)col[0] + col[1] + col[2];
+  out[1] = (uint8_t)((sum * LP_RECIP) >> LP_SHIFT);
+  for (int x = 2; x < IMG_W - 1; ++x) {
+    sum += (uint32_t)col[x + 1] - col[x - 2];
+    out[x] = (uint8_t)((sum * LP_RECIP) >> LP_SHIFT);
+  }
+}
+
+// Q4 yardımcıları: 4 piksel tek 32 bit kelimede, dallanmasız min/max.
+// Bayt başına doymalı çıkarma: her baytta max(a - b, 0)
+static inline uint32_t uqsub8(uint32_t a, uint32_t b) {
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+  return __UQSUB8(a, b);
+#else
+  uint32_t r = 0;
+  for (int i = 0; i < 32; i += 8) {
+    uint32_t x = (a >> i) & 0xFFu;
+    uint32_t y = (b >> i) & 0xFFu;
+    if (x > y) r |= (x - y) << i;
+  }
+  return r;
+#endif
+}
+
+static inline uint32_t min4(uint32_t a, uint32_t b) { return a - uqsub8(a, b); }
+static inline uint32_t max4(uint32_t a, uint32_t b) { return b + uqsub8(a, b); }
+
+static inline uint32_t med4(uint32_t a, uint32_t b, uint32_t c) {
+  return max4(min4(a, b), min4(max4(a, b), c));
+}
+
+static inline uint32_t load4(const uint8_t* p) {
+  uint32_t v;
+  memcpy(&v, p, 4);
+  return v;
+}
+
+#if (IMG_W % 4) != 0
+#error "median3x3_row satırı 4'lü sütun gruplarıyla okur, IMG_W 4'ün katı olmalı"
+#endif
+
+// Sıralanmış sütunlar (lo <= md <= hi); 4 baytlık kelime okumaları için pay
+static uint8_t col_lo[IMG_W + 4];
+static uint8_t col_md[IMG_W + 4];
+static uint8_t col_hi[IMG_W + 4];
+
+// Q4: 3x3 medyan, yalnızca 3 satırlık pencereden. Önce her sütun sıralanır,
+// sonra medyan = med3(max(lo), med3(md), min(hi)); 9 elemanlı sıralamaya
+// gerek kalmaz. out[1..IMG_W-2] geçerlidir, out IMG_W + 4 bayt olmalı.
+static void median3x3_row(const uint8_t* top, const uint8_t* mid,
+                          const uint8_t* bot, uint8_t* out) {
+  for (int x = 0; x < IMG_W; x += 4) {
+    uint32_t a = load4(&top[x]);
+    uint32_t b = load4(&mid[x]);
+    uint32_t c = load4(&bot[x]);
+    uint32_t lo = min4(a, b), hi = max4(a, b);
+    uint32_t md = min4(hi, c);
+    hi = max4(hi, c);
+    uint32_t t = max4(lo, md);
+    lo = min4(lo, md);
+    memcpy(&col_lo[x], &lo, 4);
+    memcpy(&col_md[x], &t, 4);
+    memcpy(&col_hi[x], &hi, 4);
+  }
+
+  for (int x = 1; x < IMG_W - 1; x += 4) {
+    uint32_t lo = max4(max4(load4(&col_lo[x - 1]), load4(&col_lo[x])), load4(&col_lo[x + 1]));
+    uint32_t md = med4(load4(&col_md[x - 1]), load4(&col_md[x]), load4(&col_md[x + 1]));
+    uint32_t hi = min4(min4(load4(&col_hi[x - 1]), load4(&col_hi[x])), load4(&col_hi[x + 1]));
+    uint32_t v = med4(lo, md, hi);
+    memcpy(&out[x], &v, 4);
+  }
+}
+
 // Tüm işlemleri tek fonksiyonda çalıştır
 static inline void store_window_value(size_t linear_idx, size_t offset,
                                       size_t safeN, volatile uint8_t* buffer,
@@ -174,6 +287,12 @@ static void run_image_ops(void) {
     hist_equalized[i] = 0;
   }
 
+  // Eşitlenmiş histogram piksel başına sayılmaz: v seviyesindeki tüm
+  // pikseller lut[v]'ye taşındığı için doğrudan orijinal histogramdan çıkar.
+  for (int v = 0; v < 256; ++v) {
+    hist_eq_local[lut[v]] += hist_original[v];
+  }
+
   for (size_t i = 0; i < safeN; ++i) {
     img_eq[i] = 0;
     img_lp[i] = 0;
@@ -189,7 +308,6 @@ static void run_image_ops(void) {
     for (int x = 0; x < IMG_W; ++x) {
       uint8_t eq_val = lut[IMG[y * IMG_W + x]];
       row[x] = eq_val;
-      hist_eq_local[eq_val]++;
       store_window_value(linear_idx, OFFSET, safeN, img_eq, eq_val);
       linear_idx++;
     }
@@ -199,14 +317,13 @@ static void run_image_ops(void) {
       uint8_t* row_mid = row_buf[(y - 1) % 3];
       uint8_t* row_bot = row_buf[y % 3];
       size_t row_base = (size_t)(y - 1) * IMG_W;
+      uint8_t lp_row[IMG_W];
+      uint8_t med_row[IMG_W + 4];
 
-      for (int x = 1; x < IMG_W - 1; ++x) {
-        int sum_lp =
-            row_top[x - 1] + row_top[x] + row_top[x + 1] +
-            row_mid[x - 1] + row_mid[x] + row_mid[x + 1] +
-            row_bot[x - 1] + row_bot[x] + row_bot[x + 1];
-        uint8_t lp_val = (uint8_t)(sum_lp / 9);
+      lowpass3x3_row(row_top, row_mid, row_bot, lp_row);
+      median3x3_row(row_top, row_mid, row_bot, med_row);
 
+      for (int x = 1; x < IMG_W - 1; ++x) {
         int hp_sum = 0;
         hp_sum += -row_mid[x - 1];
         hp_sum += -row_mid[x + 1];
@@ -215,26 +332,10 @@ static void run_image_ops(void) {
         hp_sum += row_mid[x] * 4;
         uint8_t hp_val = clamp_u8(hp_sum);
 
-        uint8_t window[9] = {
-            row_top[x - 1], row_top[x], row_top[x + 1],
-            row_mid[x - 1], row_mid[x], row_mid[x + 1],
-            row_bot[x - 1], row_bot[x], row_bot[x + 1],
-        };
-        for (int i = 0; i < 9; ++i) {
-          for (int j = i + 1; j < 9; ++j) {
-            if (window[j] < window[i]) {
-              uint8_t tmp = window[i];
-              window[i] = window[j];
-              window[j] = tmp;
-            }
-          }
-        }
-        uint8_t med_val = window[4];
-
         size_t idx = row_base + (size_t)x;
-        store_window_value(idx, OFFSET, safeN, img_lp, lp_val);
+        store_window_value(idx, OFFSET, safeN, img_lp, lp_row[x]);
         store_window_value(idx, OFFSET, safeN, img_hp, hp_val);
-        store_window_value(idx, OFFSET, safeN, img_med, med_val);
+        store_window_value(idx, OFFSET, safeN, img_med, med_row[x]);
       }
     }
   }
@@ -19,14 +19,22 @@ extern "C" {
 #define IMAGE_RESOLUTION_QVGA_HEIGHT		((uint16_t)240)
 #define IMAGE_RESOLUTION_QQVGA_WIDTH		((uint16_t)160)
 #define IMAGE_RESOLUTION_QQVGA_HEIGHT		((uint16_t)120)
+#define IMAGE_MAX_LINE						IMAGE_RESOLUTION_VGA_WIDTH	/* longest row/column the line buffers accept */
+#define IMAGE_OTSU_MAX_LEVELS				((uint8_t)4)	/* most thresholds IMAGE_OtsuMulti returns */
+#define IMAGE_RANK_MAX_WIN					((uint16_t)31)	/* largest window side of IMAGE_RankFilter */
 
 typedef enum
 {
 	IMAGE_FORMAT_GRAYSCALE	= 1, /* 1 Byte for each pixel  */
 	IMAGE_FORMAT_RGB565		= 2, /* 2 Bytes for each pixel */
-	IMAGE_FORMAT_RGB888		= 3, /* 3 Bytes for each pixel */
+	IMAGE_FORMAT_RGB888		= 3, /* 3 Bytes for each pixel, B G R byte order */
+	IMAGE_FORMAT_BINARY1	= 4, /* 1 Bit for each pixel, rows padded to 32-bit words, LSB first */
+	IMAGE_FORMAT_RLE		= 5, /* Per row: uint16 run count, then (x0, x1) uint16 pairs */
 }IMAGE_Format;
 
+#define IMAGE_BINARY1_WORDS(width)			(((uint32_t)(width) + 31u) >> 5)	/* 32-bit words per BINARY1 row */
+#define IMAGE_RLE_MAX_SIZE(width, height)	(2u * (uint32_t)(height) * (1u + 2u * (((uint32_t)(width) + 1u) / 2u)))	/* worst-case RLE bytes */
+
 typedef struct
 {
 	uint8_t *pData;
@@ -34,15 +42,158 @@ typedef struct
 	uint16_t height;
 	IMAGE_Format format;
 	uint32_t size;
+	uint8_t *pOcc;		/* optional per-row occupancy summary (IMAGE_OccClass), NULL = none */
 }IMAGE_HandleTypeDef;
 
+typedef enum
+{
+	IMAGE_OCC_ZERO	= 0, /* no 255 pixel in the row   */
+	IMAGE_OCC_FULL	= 1, /* every pixel of the row 255 */
+	IMAGE_OCC_MIXED	= 2, /* mixed or unknown           */
+}IMAGE_OccClass;
+
+/* Structuring element, compiled once into horizontal runs */
+#define IMAGE_SE_MAX_SIZE					((uint8_t)15)
+#define IMAGE_SE_MAX_RUNS					(IMAGE_SE_MAX_SIZE * ((IMAGE_SE_MAX_SIZE + 1) / 2))
+
+typedef struct
+{
+	int8_t  dy;		/* row offset from the anchor          */
+	int8_t  dx;		/* first column offset from the anchor */
+	uint8_t len;	/* run length in pixels                */
+}IMAGE_SERunTypeDef;
+
+typedef struct
+{
+	uint8_t width;
+	uint8_t height;
+	uint8_t cx;		/* anchor column */
+	uint8_t cy;		/* anchor row    */
+	uint8_t nruns;
+	IMAGE_SERunTypeDef runs[IMAGE_SE_MAX_RUNS];
+}IMAGE_StructElemTypeDef;
+
+typedef enum
+{
+	IMAGE_MORPH_DILATE	= 0,
+	IMAGE_MORPH_ERODE	= 1,
+	IMAGE_MORPH_OPEN	= 2,
+	IMAGE_MORPH_CLOSE	= 3,
+}IMAGE_MorphOp;
+
+/* Connected component record, see IMAGE_LabelBlobs */
+#define IMAGE_BLOB_MAX_OPEN					((uint16_t)256)	/* labels open at the same time */
+#define IMAGE_HYST_MAX_PENDING				((uint16_t)1024)	/* undecided runs IMAGE_Hysteresis queues before its flood fallback */
+
+typedef struct
+{
+	uint32_t area;
+	uint32_t perimeter;	/* 4-neighbour edge count */
+	uint16_t x_min;
+	uint16_t y_min;
+	uint16_t x_max;
+	uint16_t y_max;
+	float    cx;
+	float    cy;
+}IMAGE_BlobTypeDef;
+
+typedef struct
+{
+	uint16_t x;
+	uint16_t y;
+}IMAGE_PointTypeDef;
+
+/* Chamfer distance metrics, distances are in multiples of IMAGE_DIST_UNIT */
+typedef enum
+{
+	IMAGE_DIST_CHAMFER_3_4		= 0,
+	IMAGE_DIST_CHAMFER_5_7_11	= 1,
+}IMAGE_DistMetric;
+
+#define IMAGE_DIST_UNIT(metric)				(((metric) == IMAGE_DIST_CHAMFER_5_7_11) ? 5u : 3u)
+
+/* 3x3 LUT engine: neighbour (dx, dy) in -1..1 maps to bit (dx+1)*3 + (dy+1) of the 9-bit code */
+#define IMAGE_LUT3x3_BIT(dx, dy)			((uint16_t)(1u << (((dx) + 1) * 3 + ((dy) + 1))))
+
 int8_t LIB_IMAGE_InitStruct(IMAGE_HandleTypeDef * img, uint8_t *pImg, uint16_t height, uint16_t width, IMAGE_Format format);
+int8_t  IMAGE_Histogram(const uint8_t *pix, uint16_t width, uint16_t height, uint32_t stride,
+                        const uint8_t *lut, uint8_t *remap, uint32_t remap_stride,
+                        uint32_t hist[256], uint8_t accumulate);
+int8_t  IMAGE_HistogramRGB888(const IMAGE_HandleTypeDef *img, uint32_t histB[256], uint32_t histG[256], uint32_t histR[256]);
+int8_t  IMAGE_RGB888ToPlanar(const IMAGE_HandleTypeDef *src, uint8_t *planes);
+int8_t  IMAGE_PlanarToRGB888(const uint8_t *planes, IMAGE_HandleTypeDef *dst);
 uint8_t IMAGE_OtsuThreshold(IMAGE_HandleTypeDef *img);
+uint8_t IMAGE_OtsuFromHist(const uint32_t hist[256], uint32_t total);
+int8_t  IMAGE_OtsuMulti(const uint32_t hist[256], uint8_t nthresh, uint8_t *thresh);
+int8_t  IMAGE_ApplyMultiThreshold(IMAGE_HandleTypeDef *img, const uint8_t *thresh, uint8_t nthresh);
 void    IMAGE_ApplyThreshold(IMAGE_HandleTypeDef *img, uint8_t thresh);
-void IMAGE_Dilate3x3(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst);
-void IMAGE_Erode3x3 (const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst);
-void IMAGE_Opening3x3(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst, uint8_t *scratch);
-void IMAGE_Closing3x3(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst, uint8_t *scratch);
+int8_t  IMAGE_ThresholdBradley(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst, uint16_t kw, uint16_t kh, uint8_t t_pct);
+int8_t  IMAGE_ThresholdSauvola(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst, uint16_t kw, uint16_t kh, uint8_t k_pct, uint8_t range);
+void IMAGE_AttachOccupancy    (IMAGE_HandleTypeDef *img, uint8_t *occ);
+void IMAGE_InvalidateOccupancy(IMAGE_HandleTypeDef *img);
+int8_t IMAGE_Dilate3x3(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst);
+int8_t IMAGE_Erode3x3 (const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst);
+int8_t IMAGE_Opening3x3(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst, uint8_t *scratch);
+int8_t IMAGE_Closing3x3(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst, uint8_t *scratch);
+int8_t IMAGE_OpeningStream3x3(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst);
+int8_t IMAGE_ClosingStream3x3(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst);
+int8_t IMAGE_Gradient3x3(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst);
+int8_t IMAGE_TopHat3x3  (const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst);
+int8_t IMAGE_BlackHat3x3(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst);
+int8_t IMAGE_Dilate(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst, uint16_t kw, uint16_t kh);
+int8_t IMAGE_Erode (const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst, uint16_t kw, uint16_t kh);
+int8_t IMAGE_GrayDilate(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst, uint16_t kw, uint16_t kh);
+int8_t IMAGE_GrayErode (const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst, uint16_t kw, uint16_t kh);
+int8_t IMAGE_Median3x3(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst);
+int8_t IMAGE_Median5x5(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst);
+int8_t IMAGE_RankFilter  (const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst, uint16_t kw, uint16_t kh, uint8_t pct);
+int8_t IMAGE_MedianFilter(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst, uint16_t kw, uint16_t kh);
+int8_t IMAGE_BoxFilter   (const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst, uint16_t kw, uint16_t kh);
+
+int8_t IMAGE_PackBinary  (const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst);
+int8_t IMAGE_UnpackBinary(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst);
+int8_t IMAGE_DilateBinary3x3 (const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst);
+int8_t IMAGE_ErodeBinary3x3  (const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst);
+int8_t IMAGE_OpeningBinary3x3(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst);
+int8_t IMAGE_ClosingBinary3x3(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst);
+
+int8_t IMAGE_ThresholdRLE (const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst, uint8_t thresh);
+int8_t IMAGE_PackRLE      (const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst);
+int8_t IMAGE_UnpackRLE    (const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst);
+int8_t IMAGE_DilateRLE3x3 (const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst);
+int8_t IMAGE_ErodeRLE3x3  (const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst);
+int8_t IMAGE_OpeningRLE3x3(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst);
+int8_t IMAGE_ClosingRLE3x3(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst);
+int8_t IMAGE_AndRLE(const IMAGE_HandleTypeDef *a, const IMAGE_HandleTypeDef *b, IMAGE_HandleTypeDef *dst);
+int8_t IMAGE_OrRLE (const IMAGE_HandleTypeDef *a, const IMAGE_HandleTypeDef *b, IMAGE_HandleTypeDef *dst);
+int8_t IMAGE_XorRLE(const IMAGE_HandleTypeDef *a, const IMAGE_HandleTypeDef *b, IMAGE_HandleTypeDef *dst);
+
+int8_t IMAGE_SE_FromMask(IMAGE_StructElemTypeDef *se, const uint8_t *mask, uint8_t width, uint8_t height);
+int8_t IMAGE_SE_Rect   (IMAGE_StructElemTypeDef *se, uint8_t width, uint8_t height);
+int8_t IMAGE_SE_Cross  (IMAGE_StructElemTypeDef *se, uint8_t size);
+int8_t IMAGE_SE_Diamond(IMAGE_StructElemTypeDef *se, uint8_t radius);
+int8_t IMAGE_SE_Disk   (IMAGE_StructElemTypeDef *se, uint8_t radius);
+int8_t IMAGE_SE_Line   (IMAGE_StructElemTypeDef *se, uint8_t length, int16_t angle_deg);
+int8_t IMAGE_Morph(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst, const IMAGE_StructElemTypeDef *se, IMAGE_MorphOp op);
+int8_t IMAGE_MorphIterate(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst, IMAGE_MorphOp op, uint16_t max_iter);
+
+int8_t IMAGE_LabelBlobs(const IMAGE_HandleTypeDef *img, IMAGE_BlobTypeDef *blobs, uint16_t max_blobs, uint16_t *count);
+int8_t IMAGE_Hysteresis(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst, uint8_t lo, uint8_t hi);
+int8_t IMAGE_HysteresisOtsu(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst);
+int8_t IMAGE_ApplyLUT3x3(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst, const uint8_t lut[512], uint32_t *changed);
+void   IMAGE_LUT3x3_Dilate   (uint8_t lut[512]);
+void   IMAGE_LUT3x3_Erode    (uint8_t lut[512]);
+void   IMAGE_LUT3x3_HitOrMiss(uint8_t lut[512], uint16_t hit, uint16_t miss);
+void   IMAGE_LUT3x3_Endpoints(uint8_t lut[512]);
+void   IMAGE_LUT3x3_ZhangSuen(uint8_t lut[512], uint8_t pass);
+int8_t IMAGE_Skeletonize(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst, uint16_t max_iter);
+int8_t IMAGE_ListPixels (const IMAGE_HandleTypeDef *img, IMAGE_PointTypeDef *pts, uint32_t max_pts, uint32_t *count);
+int8_t IMAGE_DistanceTransform (const IMAGE_HandleTypeDef *src, uint16_t *dist, IMAGE_DistMetric metric);
+int8_t IMAGE_DistanceTransform8(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst, IMAGE_DistMetric metric);
+int8_t IMAGE_ReconstructDilate(const IMAGE_HandleTypeDef *mask, IMAGE_HandleTypeDef *marker);
+int8_t IMAGE_ReconstructErode (const IMAGE_HandleTypeDef *mask, IMAGE_HandleTypeDef *marker);
+int8_t IMAGE_FillHoles  (const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst);
+int8_t IMAGE_ClearBorder(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst);
 
 #ifdef __cplusplus
 }
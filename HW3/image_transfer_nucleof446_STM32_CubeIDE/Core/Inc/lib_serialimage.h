@@ -21,6 +21,7 @@ extern UART_HandleTypeDef 	__huart;
 
 int8_t LIB_SERIAL_IMG_Transmit(IMAGE_HandleTypeDef * img);
 int8_t LIB_SERIAL_IMG_Receive(IMAGE_HandleTypeDef * img);
+int8_t LIB_SERIAL_IMG_ReceiveHist(IMAGE_HandleTypeDef * img, uint32_t hist[256]);
 
 #ifdef __cplusplus
 }
@@ -5,12 +5,14 @@
   * @param  pImg    Pointer to image buffer
   * @param  height  Height of the image in pixels
   * @param  width   Width of the image in pixels
-  * @param  format  Choose IMAGE_FORMAT_GRAYSCALE, IMAGE_FORMAT_RGB565, or IMAGE_FORMAT_RGB888
+  * @param  format  Choose IMAGE_FORMAT_GRAYSCALE, IMAGE_FORMAT_RGB565, IMAGE_FORMAT_RGB888, IMAGE_FORMAT_BINARY1 or IMAGE_FORMAT_RLE
   * @retval 0 if successfully initialized, -1 otherwise
 
  */
 #include <string.h>
 #include <stdint.h>
+#include <stdlib.h>
+#include <math.h>
 #include "lib_image.h"
 
 static uint8_t Otsu_FromHist256(const uint32_t hist[256], uint32_t total);
@@ -26,118 +28,3225 @@ static inline uint8_t _px_get0(const uint8_t *p, int x, int y, int w, int h)
 }
 
 
-void IMAGE_Dilate3x3(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst)
+// Tek satırın yatay 3'lü OR (dilate) / AND (erode) sonucu, satır dışı 0.
+// binarize != 0 ise giriş önce 255 -> 255, diğerleri -> 0 yapılır.
+static void _row_h3(const uint8_t *in, uint8_t *out, int w, uint8_t erode, uint8_t binarize)
 {
-    if (!src || !dst || !src->pData || !dst->pData) return;
-    if (src->format != IMAGE_FORMAT_GRAYSCALE || dst->format != IMAGE_FORMAT_GRAYSCALE) return;
-    if (src->width != dst->width || src->height != dst->height) return;
+    uint8_t prev = 0;
+    uint8_t cur = binarize ? ((in[0] == 255) ? 255 : 0) : in[0];
+
+    for (int x = 0; x < w; x++)
+    {
+        uint8_t next = 0;
+        if (x + 1 < w) next = binarize ? ((in[x+1] == 255) ? 255 : 0) : in[x+1];
+
+        out[x] = erode ? (uint8_t)(prev & cur & next) : (uint8_t)(prev | cur | next);
+        prev = cur;
+        cur = next;
+    }
+}
+
+// Üç satırın dikey OR/AND'i. up/down NULL ise satır çerçeve dışındadır (0).
+static void _row_v3(const uint8_t *up, const uint8_t *mid, const uint8_t *down,
+                    uint8_t *out, int w, uint8_t erode)
+{
+    if (erode)
+    {
+        if (!up || !down) { memset(out, 0, (size_t)w); return; }
+        for (int x = 0; x < w; x++) out[x] = up[x] & mid[x] & down[x];
+    }
+    else
+    {
+        for (int x = 0; x < w; x++)
+            out[x] = mid[x] | (up ? up[x] : 0) | (down ? down[x] : 0);
+    }
+}
+
+/* ---------------------------------------------------------------------------
+ * Satır doluluk özeti (img->pOcc, height bayt): IMAGE_OCC_ZERO = satırda 255
+ * yok, IMAGE_OCC_FULL = tüm satır 255, IMAGE_OCC_MIXED = bilinmiyor/karışık.
+ * IMAGE_ApplyThreshold ve 3x3 dilate/erode bunu yan ürün olarak yazar ve
+ * okur; tekdüze satırlar okunmaz, sonucu belli satırlar memset ile dolar.
+ * Özeti tutmayan fonksiyonlar yazdıkları görüntünün özetini MIXED yapar.
+ * ------------------------------------------------------------------------- */
+
+static inline void _occ_reset(IMAGE_HandleTypeDef *img)
+{
+    if (img->pOcc) memset(img->pOcc, IMAGE_OCC_MIXED, img->height);
+}
+
+/**
+  * @brief  Attach a row occupancy summary (height bytes) to img, or detach with NULL.
+  *         The summary starts as IMAGE_OCC_MIXED for every row.
+  */
+void IMAGE_AttachOccupancy(IMAGE_HandleTypeDef *img, uint8_t *occ)
+{
+    if (!img) return;
+    img->pOcc = occ;
+    _occ_reset(img);
+}
+
+// pData dışarıdan (DMA, UART, elle) yazıldıysa çağrılmalı
+void IMAGE_InvalidateOccupancy(IMAGE_HandleTypeDef *img)
+{
+    if (img) _occ_reset(img);
+}
+
+static uint8_t _occ_classify(const uint8_t *row, int w)
+{
+    uint8_t any = 0, all = 255;
+    for (int x = 0; x < w; x++)
+    {
+        const uint8_t b = (row[x] == 255) ? 255 : 0;
+        any |= b;
+        all &= b;
+    }
+    return all ? IMAGE_OCC_FULL : (any ? IMAGE_OCC_MIXED : IMAGE_OCC_ZERO);
+}
+
+// Tekdüze bir satırın yatay 3'lü sonucu, satır okunmadan
+static void _occ_row_h3(uint8_t cls, uint8_t *out, int w, uint8_t erode)
+{
+    if (cls == IMAGE_OCC_ZERO) { memset(out, 0, (size_t)w); return; }
+
+    memset(out, 255, (size_t)w);
+    if (erode) { out[0] = 0; out[w - 1] = 0; }
+}
+
+// src satırı r'nin sınıfı ve yatay sonucu halkaya; tekdüze satır okunmaz
+static void _occ_load(const uint8_t *in, int w, int r, uint8_t erode, const uint8_t *occ_in,
+                      uint8_t hr[3][IMAGE_MAX_LINE], uint8_t cls[3])
+{
+    cls[r % 3] = occ_in ? occ_in[r] : IMAGE_OCC_MIXED;
+
+    if (cls[r % 3] == IMAGE_OCC_MIXED) _row_h3(in + r*w, hr[r % 3], w, erode, 1);
+    else _occ_row_h3(cls[r % 3], hr[r % 3], w, erode);
+}
+
+// 3x3 dilate/erode çekirdeği. Yatay sonuçlar 3 satırlık halkada (geçmiş)
+// tutulur; çıkış satırı y, src satırı y+1 okunduktan sonra yazıldığı için
+// in == out (yerinde) çalışır. w > IMAGE_MAX_LINE satırlarda eski piksel
+// döngüsüne düşer; o yol yerinde çalışamaz, in == out ise IMAGE_ERROR döner.
+// occ_in/occ_out NULL olabilir; aynı buffer da olabilirler (yerinde).
+static int8_t _morph3x3(const uint8_t *in, uint8_t *out, int w, int h, uint8_t erode,
+                      const uint8_t *occ_in, uint8_t *occ_out)
+{
+    if (w > IMAGE_MAX_LINE)
+    {
+        if (in == out) return IMAGE_ERROR;
+
+        for (int y = 0; y < h; y++)
+        {
+            for (int x = 0; x < w; x++)
+            {
+                uint8_t any = 0, all = 1;
+
+                for (int j = -1; j <= 1; j++)
+                {
+                    for (int i = -1; i <= 1; i++)
+                    {
+                        if (_px_get0(in, x+i, y+j, w, h) == 255) any = 1;
+                        else all = 0;
+                    }
+                }
+                out[y*w + x] = (erode ? all : any) ? 255 : 0;
+            }
+        }
+        if (occ_out) memset(occ_out, IMAGE_OCC_MIXED, (size_t)h);
+        return IMAGE_OK;
+    }
+
+    static uint8_t hr[3][IMAGE_MAX_LINE];   // ~2 KB, stack yerine statik
+    uint8_t cls[3];     // src satır sınıfları, yerinde yazımdan önce okunur
+
+    _occ_load(in, w, 0, erode, occ_in, hr, cls);
+
+    for (int y = 0; y < h; y++)
+    {
+        const uint8_t *up = (y > 0) ? hr[(y + 2) % 3] : NULL;
+        const uint8_t *down = NULL;
+        uint8_t cu = (y > 0) ? cls[(y + 2) % 3] : IMAGE_OCC_ZERO;
+        uint8_t cd = IMAGE_OCC_ZERO;
+
+        if (y + 1 < h)
+        {
+            _occ_load(in, w, y + 1, erode, occ_in, hr, cls);
+            down = hr[(y + 1) % 3];
+            cd = cls[(y + 1) % 3];
+        }
+
+        const uint8_t cm = cls[y % 3];
+        uint8_t *o = out + y*w;
+        uint8_t co;
+
+        if (!erode && cu == IMAGE_OCC_ZERO && cm == IMAGE_OCC_ZERO && cd == IMAGE_OCC_ZERO)
+        {
+            memset(o, 0, (size_t)w); co = IMAGE_OCC_ZERO;
+        }
+        else if (!erode && (cu == IMAGE_OCC_FULL || cm == IMAGE_OCC_FULL || cd == IMAGE_OCC_FULL))
+        {
+            memset(o, 255, (size_t)w); co = IMAGE_OCC_FULL;
+        }
+        else if (erode && (!up || !down || cu == IMAGE_OCC_ZERO || cm == IMAGE_OCC_ZERO || cd == IMAGE_OCC_ZERO))
+        {
+            memset(o, 0, (size_t)w); co = IMAGE_OCC_ZERO;
+        }
+        else if (erode && cu == IMAGE_OCC_FULL && cm == IMAGE_OCC_FULL && cd == IMAGE_OCC_FULL)
+        {
+            _occ_row_h3(IMAGE_OCC_FULL, o, w, 1);
+            co = (w > 2) ? IMAGE_OCC_MIXED : IMAGE_OCC_ZERO;
+        }
+        else
+        {
+            _row_v3(up, hr[y % 3], down, o, w, erode);
+            co = occ_out ? _occ_classify(o, w) : IMAGE_OCC_MIXED;
+        }
+
+        if (occ_out) occ_out[y] = co;
+    }
+    return IMAGE_OK;
+}
+
+// dst = dilate(src)   (3x3)
+// src == dst olabilir, yalnızca width <= IMAGE_MAX_LINE iken; daha geniş
+// karede yerinde çağrı IMAGE_ERROR döner ve dst'ye dokunulmaz.
+int8_t IMAGE_Dilate3x3(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst)
+{
+    if (!src || !dst || !src->pData || !dst->pData) return IMAGE_ERROR;
+    if (src->format != IMAGE_FORMAT_GRAYSCALE || dst->format != IMAGE_FORMAT_GRAYSCALE) return IMAGE_ERROR;
+    if (src->width != dst->width || src->height != dst->height) return IMAGE_ERROR;
+
+    return _morph3x3(src->pData, dst->pData, src->width, src->height, 0, src->pOcc, dst->pOcc);
+}
+
+// dst = erode(src)   (3x3)
+// src == dst olabilir, yalnızca width <= IMAGE_MAX_LINE iken; daha geniş
+// karede yerinde çağrı IMAGE_ERROR döner ve dst'ye dokunulmaz.
+// Sınır dışı 0 sayıldığı için kenarlar daha kolay erozyona uğrar .
+int8_t IMAGE_Erode3x3(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst)
+{
+    if (!src || !dst || !src->pData || !dst->pData) return IMAGE_ERROR;
+    if (src->format != IMAGE_FORMAT_GRAYSCALE || dst->format != IMAGE_FORMAT_GRAYSCALE) return IMAGE_ERROR;
+    if (src->width != dst->width || src->height != dst->height) return IMAGE_ERROR;
+
+    return _morph3x3(src->pData, dst->pData, src->width, src->height, 1, src->pOcc, dst->pOcc);
+}
+
+// opening = erosion -> dilation
+// scratch NULL ise tek buffer üzerinde yerinde (src == dst de olabilir);
+// bu yol width > IMAGE_MAX_LINE karelerde IMAGE_ERROR döner, scratch verin.
+int8_t IMAGE_Opening3x3(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst, uint8_t *scratch)
+{
+    if (!src || !dst) return IMAGE_ERROR;
+    if (!scratch)
+    {
+        if (IMAGE_Erode3x3(src, dst) != IMAGE_OK) return IMAGE_ERROR;
+        return IMAGE_Dilate3x3(dst, dst);
+    }
+    IMAGE_HandleTypeDef tmp = *dst;
+    tmp.pData = scratch;
+    tmp.pOcc = NULL;
+
+    if (IMAGE_Erode3x3(src, &tmp) != IMAGE_OK) return IMAGE_ERROR;
+    return IMAGE_Dilate3x3(&tmp, dst);
+}
+
+// closing = dilation -> erosion
+// scratch NULL ise tek buffer üzerinde yerinde (src == dst de olabilir);
+// bu yol width > IMAGE_MAX_LINE karelerde IMAGE_ERROR döner, scratch verin.
+int8_t IMAGE_Closing3x3(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst, uint8_t *scratch)
+{
+    if (!src || !dst) return IMAGE_ERROR;
+    if (!scratch)
+    {
+        if (IMAGE_Dilate3x3(src, dst) != IMAGE_OK) return IMAGE_ERROR;
+        return IMAGE_Erode3x3(dst, dst);
+    }
+    IMAGE_HandleTypeDef tmp = *dst;
+    tmp.pData = scratch;
+    tmp.pOcc = NULL;
+
+    if (IMAGE_Dilate3x3(src, &tmp) != IMAGE_OK) return IMAGE_ERROR;
+    return IMAGE_Erode3x3(&tmp, dst);
+}
+
+// Fused 3x3 opening/closing: birinci işlemin satırları 3 satırlık halkada
+// tutulur ve ikinci işlem bunlardan akarak dst'ye yazar. Tam kare ara buffer
+// gerekmez, src bir kez okunur, dst bir kez yazılır. Çıkış satırı y, src
+// satırı y+2 okunduktan sonra yazıldığı için src == dst de güvenlidir.
+// residue: 0 = sonucu yaz, 1 = src - sonuç (top-hat), 2 = sonuç - src (black-hat)
+static int8_t _morph3x3_pair_stream(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst,
+                                    uint8_t first_erode, uint8_t residue)
+{
+    if (!src || !dst || !src->pData || !dst->pData) return IMAGE_ERROR;
+    if (src->format != IMAGE_FORMAT_GRAYSCALE || dst->format != IMAGE_FORMAT_GRAYSCALE) return IMAGE_ERROR;
+    if (src->width != dst->width || src->height != dst->height) return IMAGE_ERROR;
+    if (src->width > IMAGE_MAX_LINE) return IMAGE_ERROR;
+    _occ_reset(dst);
+
+    const int w = src->width;
+    const int h = src->height;
+    const uint8_t *in = src->pData;
+    uint8_t *out = dst->pData;
+    const uint8_t e1 = first_erode;
+    const uint8_t e2 = !first_erode;
+
+    // ~4.5 KB, 1 KB'lık stack yerine statik
+    static uint8_t h1[3][IMAGE_MAX_LINE];   // src satırlarının yatay op1 sonucu
+    static uint8_t h2[3][IMAGE_MAX_LINE];   // ara satırların yatay op2 sonucu
+    static uint8_t mid[IMAGE_MAX_LINE];
+
+    // t: okunan src satırı, r = t-1: ara satır, y = t-2: çıkış satırı
+    for (int t = 0; t < h + 2; t++)
+    {
+        if (t < h)
+            _row_h3(in + t*w, h1[t % 3], w, e1, 1);
+
+        int r = t - 1;
+        if (r >= 0 && r < h)
+        {
+            _row_v3((r > 0) ? h1[(r - 1) % 3] : NULL, h1[r % 3], (r + 1 < h) ? h1[(r + 1) % 3] : NULL, mid, w, e1);
+            _row_h3(mid, h2[r % 3], w, e2, 0);
+        }
+
+        int y = t - 2;
+        if (y < 0) continue;
+
+        const uint8_t *up = (y > 0) ? h2[(y - 1) % 3] : NULL;
+        const uint8_t *down = (y + 1 < h) ? h2[(y + 1) % 3] : NULL;
+
+        if (residue == 0)
+        {
+            _row_v3(up, h2[y % 3], down, out + y*w, w, e2);
+            continue;
+        }
+
+        // src satırı y henüz üzerine yazılmadı, farkı piksel piksel al
+        _row_v3(up, h2[y % 3], down, mid, w, e2);
+        const uint8_t *s = in + y*w;
+        uint8_t *o = out + y*w;
+        for (int x = 0; x < w; x++)
+        {
+            uint8_t b = (s[x] == 255) ? 255 : 0;
+            o[x] = (residue == 1) ? (uint8_t)(b & ~mid[x]) : (uint8_t)(mid[x] & ~b);
+        }
+    }
+
+    return IMAGE_OK;
+}
+
+// IMAGE_Opening3x3 ile aynı sonuç, scratch frame olmadan tek geçişte
+int8_t IMAGE_OpeningStream3x3(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst)
+{
+    return _morph3x3_pair_stream(src, dst, 1, 0);
+}
+
+// IMAGE_Closing3x3 ile aynı sonuç, scratch frame olmadan tek geçişte
+int8_t IMAGE_ClosingStream3x3(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst)
+{
+    return _morph3x3_pair_stream(src, dst, 0, 0);
+}
+
+// top-hat = src - opening(src), tek geçişte
+int8_t IMAGE_TopHat3x3(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst)
+{
+    return _morph3x3_pair_stream(src, dst, 1, 1);
+}
+
+// black-hat = closing(src) - src, tek geçişte
+int8_t IMAGE_BlackHat3x3(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst)
+{
+    return _morph3x3_pair_stream(src, dst, 0, 2);
+}
+
+// gradient = dilate(src) - erode(src). Her src satırının yatay OR ve AND'i
+// bir kez hesaplanıp iki halkada tutulur, ara frame yazılmaz. src == dst olabilir.
+int8_t IMAGE_Gradient3x3(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst)
+{
+    if (!src || !dst || !src->pData || !dst->pData) return IMAGE_ERROR;
+    if (src->format != IMAGE_FORMAT_GRAYSCALE || dst->format != IMAGE_FORMAT_GRAYSCALE) return IMAGE_ERROR;
+    if (src->width != dst->width || src->height != dst->height) return IMAGE_ERROR;
+    if (src->width > IMAGE_MAX_LINE) return IMAGE_ERROR;
+    _occ_reset(dst);
+
+    const int w = src->width;
+    const int h = src->height;
+    const uint8_t *in = src->pData;
+    uint8_t *out = dst->pData;
+
+    // ~3.8 KB, 1 KB'lık stack yerine statik
+    static uint8_t hmax[3][IMAGE_MAX_LINE];
+    static uint8_t hmin[3][IMAGE_MAX_LINE];
+
+    _row_h3(in, hmax[0], w, 0, 1);
+    _row_h3(in, hmin[0], w, 1, 1);
+
+    for (int y = 0; y < h; y++)
+    {
+        const int c = y % 3, p = (y + 2) % 3, n = (y + 1) % 3;
+
+        if (y + 1 < h)
+        {
+            _row_h3(in + (y + 1)*w, hmax[n], w, 0, 1);
+            _row_h3(in + (y + 1)*w, hmin[n], w, 1, 1);
+        }
+
+        uint8_t *o = out + y*w;
+        if (y == 0 || y + 1 == h)
+        {
+            // erozyon kenar satırlarında 0, gradyan = dilatasyon
+            _row_v3((y > 0) ? hmax[p] : NULL, hmax[c], (y + 1 < h) ? hmax[n] : NULL, o, w, 0);
+            continue;
+        }
+
+        for (int x = 0; x < w; x++)
+        {
+            uint8_t vmax = hmax[p][x] | hmax[c][x] | hmax[n][x];
+            uint8_t vmin = hmin[p][x] & hmin[c][x] & hmin[n][x];
+            o[x] = vmax & (uint8_t)~vmin;
+        }
+    }
+
+    return IMAGE_OK;
+}
+
+// van Herk / Gil-Werman running OR over one line, in place.
+// Window covers r pixels behind and s pixels ahead, outside the line reads `pad`.
+// g and hb need n + r + s bytes. 3 ORs per pixel whatever r + s is.
+static void _vhgw_or_line(uint8_t *line, int n, int r, int s, uint8_t pad, uint8_t *g, uint8_t *hb)
+{
+    const int k = r + s + 1;
+    const int L = n + r + s;
+
+    memset(hb, pad, (size_t)r);
+    memcpy(hb + r, line, (size_t)n);
+    memset(hb + r + n, pad, (size_t)s);
+
+    // g: prefix OR from the start of each k-block
+    for (int i = 0, c = 0; i < L; i++)
+    {
+        g[i] = (c == 0) ? hb[i] : (uint8_t)(g[i-1] | hb[i]);
+        if (++c == k) c = 0;
+    }
+
+    // hb: suffix OR up to the end of each k-block (last block may be short)
+    for (int i = L - 2, c = (L - 2) % k; i >= 0; i--, c--)
+    {
+        if (c < 0) c = k - 1;
+        if (c != k - 1) hb[i] |= hb[i+1];
+    }
+
+    for (int x = 0; x < n; x++)
+        line[x] = hb[x] | g[x + k - 1];
+}
+
+// Separable kw x kh binary dilation/erosion, anchor at (kw/2, kh/2).
+// Erosion runs as a dilation of the complement with 255 padding, so
+// out-of-frame pixels still count as 0 exactly like IMAGE_Erode3x3.
+// src and dst may be the same buffer.
+static int8_t _binary_morph_rect(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst,
+                                 uint16_t kw, uint16_t kh, uint8_t erode)
+{
+    if (!src || !dst || !src->pData || !dst->pData) return IMAGE_ERROR;
+    if (src->format != IMAGE_FORMAT_GRAYSCALE || dst->format != IMAGE_FORMAT_GRAYSCALE) return IMAGE_ERROR;
+    if (src->width != dst->width || src->height != dst->height) return IMAGE_ERROR;
+    if (kw == 0 || kh == 0) return IMAGE_ERROR;
+    if (src->width > IMAGE_MAX_LINE || src->height > IMAGE_MAX_LINE) return IMAGE_ERROR;
+    _occ_reset(dst);
+
+    const int w = src->width;
+    const int h = src->height;
+    const uint8_t *in = src->pData;
+    uint8_t *out = dst->pData;
+    const uint8_t inv = erode ? 0xFF : 0x00;
+
+    // Reaching further than the frame only adds padding, so clamp it.
+    int rx = kw / 2, sx = kw - 1 - rx;
+    int ry = kh / 2, sy = kh - 1 - ry;
+    if (rx > w) rx = w;
+    if (sx > w) sx = w;
+    if (ry > h) ry = h;
+    if (sy > h) sy = h;
+
+    // ~4.5 KB of line buffers, static so they stay off the 1 KB stack
+    static uint8_t g[3 * IMAGE_MAX_LINE];
+    static uint8_t hb[3 * IMAGE_MAX_LINE];
+    static uint8_t col[IMAGE_MAX_LINE];
+
+    // yatay geçiş: src satırı -> dst satırı (erozyonda tümleyen olarak kalır)
+    for (int y = 0; y < h; y++)
+    {
+        const uint8_t *ip = in + y*w;
+        uint8_t *op = out + y*w;
+
+        for (int x = 0; x < w; x++)
+            op[x] = (uint8_t)(((ip[x] == 255) ? 255 : 0) ^ inv);
+
+        _vhgw_or_line(op, w, rx, sx, inv, g, hb);
+    }
+
+    // dikey geçiş: dst sütunları yerinde
+    for (int x = 0; x < w; x++)
+    {
+        for (int y = 0; y < h; y++) col[y] = out[y*w + x];
+
+        _vhgw_or_line(col, h, ry, sy, inv, g, hb);
+
+        for (int y = 0; y < h; y++) out[y*w + x] = col[y] ^ inv;
+    }
+
+    return IMAGE_OK;
+}
+
+// dst = dilate(src) with a kw x kh rectangle.
+// Odd sizes give the same result as (k-1)/2 chained IMAGE_Dilate3x3 passes.
+int8_t IMAGE_Dilate(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst, uint16_t kw, uint16_t kh)
+{
+    return _binary_morph_rect(src, dst, kw, kh, 0);
+}
+
+// dst = erode(src) with a kw x kh rectangle.
+// Odd sizes give the same result as (k-1)/2 chained IMAGE_Erode3x3 passes.
+int8_t IMAGE_Erode(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst, uint16_t kw, uint16_t kh)
+{
+    return _binary_morph_rect(src, dst, kw, kh, 1);
+}
+
+/* ---------------------------------------------------------------------------
+ * Gri seviye (rank) morfoloji: dilate = pencere maksimumu, erode = pencere
+ * minimumu. Ayrıştırılabilir; her satır/sütun monoton deque ile süzülür,
+ * pencere boyu ne olursa olsun piksel başına amortize O(1). Çerçeve dışı
+ * pikseller pencereye katılmaz. RGB565/RGB888'de R/G/B alanları ayrı süzülür.
+ * ------------------------------------------------------------------------- */
+
+// Kayan pencere maksimumu: out[x] = max(v[x-r .. x+s]) (satıra kırpılmış).
+// dq en az n indeks tutmalı.
+static void _deque_max_line(const uint8_t *v, uint8_t *out, int n, int r, int s, uint16_t *dq)
+{
+    int head = 0, tail = 0;   // dq[head..tail-1], değerler azalan sırada
+    int next = 0;             // sıradaki eklenecek indeks
+
+    for (int x = 0; x < n; x++)
+    {
+        int hi = x + s;
+        if (hi > n - 1) hi = n - 1;
+
+        for (; next <= hi; next++)
+        {
+            while (tail > head && v[dq[tail - 1]] <= v[next]) tail--;
+            dq[tail++] = (uint16_t)next;
+        }
+        while (dq[head] < x - r) head++;
+
+        out[x] = v[dq[head]];
+    }
+}
+
+// RGB565 piksel <-> 3 kanal. Kanallar 0..31 / 0..63 aralığında kalır.
+static inline void _rgb565_split(const uint8_t *p, uint8_t *r, uint8_t *g, uint8_t *b)
+{
+    uint16_t pix = (uint16_t)p[0] | ((uint16_t)p[1] << 8);
+    *r = (pix >> 11) & 0x1F;
+    *g = (pix >> 5)  & 0x3F;
+    *b =  pix        & 0x1F;
+}
+
+static inline void _rgb565_join(uint8_t *p, uint8_t r, uint8_t g, uint8_t b)
+{
+    uint16_t pix = (uint16_t)(((uint16_t)r << 11) | ((uint16_t)g << 5) | b);
+    p[0] = (uint8_t)(pix & 0xFF);
+    p[1] = (uint8_t)(pix >> 8);
+}
+
+// Bir satır ya da sütunu (adım = stride piksel) kanal kanal süzer.
+// Erozyon için değerler 0xFF ile XOR'lanıp maksimum alınır (min = ~max(~v)).
+static void _rank_line(uint8_t *base, int n, int stride, IMAGE_Format fmt, int r, int s, uint8_t inv,
+                       uint8_t ch[3][IMAGE_MAX_LINE], uint8_t *tmp, uint16_t *dq)
+{
+    const int bpp = (int)fmt;
+    const int nch = (fmt == IMAGE_FORMAT_GRAYSCALE) ? 1 : 3;
+
+    if (fmt == IMAGE_FORMAT_GRAYSCALE)
+    {
+        for (int i = 0; i < n; i++) ch[0][i] = base[i * stride] ^ inv;
+    }
+    else if (fmt == IMAGE_FORMAT_RGB565)
+    {
+        for (int i = 0; i < n; i++)
+        {
+            uint8_t cr, cg, cb;
+            _rgb565_split(base + i * stride * bpp, &cr, &cg, &cb);
+            ch[0][i] = cr ^ inv; ch[1][i] = cg ^ inv; ch[2][i] = cb ^ inv;
+        }
+    }
+    else
+    {
+        // RGB888: baytlar doğrudan kanal
+        for (int i = 0; i < n; i++)
+        {
+            const uint8_t *q = base + i * stride * bpp;
+            ch[0][i] = q[0] ^ inv; ch[1][i] = q[1] ^ inv; ch[2][i] = q[2] ^ inv;
+        }
+    }
+
+    for (int c = 0; c < nch; c++)
+    {
+        _deque_max_line(ch[c], tmp, n, r, s, dq);
+        memcpy(ch[c], tmp, (size_t)n);
+    }
+
+    if (fmt == IMAGE_FORMAT_GRAYSCALE)
+    {
+        for (int i = 0; i < n; i++) base[i * stride] = ch[0][i] ^ inv;
+    }
+    else if (fmt == IMAGE_FORMAT_RGB565)
+    {
+        for (int i = 0; i < n; i++)
+            _rgb565_join(base + i * stride * bpp, (ch[0][i] ^ inv) & 0x1F, (ch[1][i] ^ inv) & 0x3F, (ch[2][i] ^ inv) & 0x1F);
+    }
+    else
+    {
+        for (int i = 0; i < n; i++)
+        {
+            uint8_t *q = base + i * stride * bpp;
+            q[0] = ch[0][i] ^ inv; q[1] = ch[1][i] ^ inv; q[2] = ch[2][i] ^ inv;
+        }
+    }
+}
+
+static int8_t _rank_morph(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst,
+                          uint16_t kw, uint16_t kh, uint8_t erode)
+{
+    if (!src || !dst || !src->pData || !dst->pData) return IMAGE_ERROR;
+    if (src->format != dst->format) return IMAGE_ERROR;
+    if (src->format != IMAGE_FORMAT_GRAYSCALE && src->format != IMAGE_FORMAT_RGB565 &&
+        src->format != IMAGE_FORMAT_RGB888) return IMAGE_ERROR;
+    if (src->width != dst->width || src->height != dst->height) return IMAGE_ERROR;
+    if (kw == 0 || kh == 0) return IMAGE_ERROR;
+    if (src->width > IMAGE_MAX_LINE || src->height > IMAGE_MAX_LINE) return IMAGE_ERROR;
+    _occ_reset(dst);
+
+    const int w = src->width;
+    const int h = src->height;
+    const IMAGE_Format fmt = src->format;
+    const uint8_t inv = erode ? 0xFF : 0x00;
+
+    // pencere satıra kırpıldığı için n-1'den uzun erişim anlamsız
+    int rx = kw / 2, sx = kw - 1 - rx;
+    int ry = kh / 2, sy = kh - 1 - ry;
+    if (rx > w - 1) rx = w - 1;
+    if (sx > w - 1) sx = w - 1;
+    if (ry > h - 1) ry = h - 1;
+    if (sy > h - 1) sy = h - 1;
+
+    // ~3.2 KB, 1 KB'lık stack yerine statik
+    static uint8_t ch[3][IMAGE_MAX_LINE];
+    static uint8_t tmp[IMAGE_MAX_LINE];
+    static uint16_t dq[IMAGE_MAX_LINE];
+
+    if (src->pData != dst->pData) memcpy(dst->pData, src->pData, src->size);
+
+    for (int y = 0; y < h; y++)
+        _rank_line(dst->pData + (uint32_t)y * w * fmt, w, 1, fmt, rx, sx, inv, ch, tmp, dq);
+
+    for (int x = 0; x < w; x++)
+        _rank_line(dst->pData + (uint32_t)x * fmt, h, w, fmt, ry, sy, inv, ch, tmp, dq);
+
+    return IMAGE_OK;
+}
+
+// dst = kw x kh pencere maksimumu (gri seviye dilatasyon), src == dst olabilir
+int8_t IMAGE_GrayDilate(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst, uint16_t kw, uint16_t kh)
+{
+    return _rank_morph(src, dst, kw, kh, 0);
+}
+
+// dst = kw x kh pencere minimumu (gri seviye erozyon), src == dst olabilir
+int8_t IMAGE_GrayErode(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst, uint16_t kw, uint16_t kh)
+{
+    return _rank_morph(src, dst, kw, kh, 1);
+}
+
+/* ---------------------------------------------------------------------------
+ * Sıralama ağlı medyan filtreleri (3x3, 5x5). Her satırda pencere sütunları
+ * bir kez dikey sıralanır ve komşu pikseller tarafından yeniden kullanılır;
+ * yatay adım yalnızca sıralı sütunları birleştirir. Tüm karşılaştır-değiştir
+ * adımları dallanmasız min/max'tır ve bir 32-bit kelimede 4 piksel birden
+ * işlenir (Cortex-M4'te __UQSUB8). Çerçeve kenarı kopyalanarak uzatılır.
+ * ------------------------------------------------------------------------- */
+
+// bayt bazında doyumlu a - b
+static inline uint32_t _uqsub8(uint32_t a, uint32_t b)
+{
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+    return __UQSUB8(a, b);
+#else
+    uint32_t r = 0;
+    for (int s = 0; s < 32; s += 8)
+    {
+        uint32_t x = (a >> s) & 0xFFu, y = (b >> s) & 0xFFu;
+        r |= ((x > y) ? x - y : 0u) << s;
+    }
+    return r;
+#endif
+}
+
+// min = a - (a -. b), max = b + (a -. b); bayt sınırından taşma olmaz
+#define _VCE(a, b)	do { uint32_t _t = _uqsub8((a), (b)); (a) -= _t; (b) += _t; } while (0)
+
+static inline uint32_t _vmin(uint32_t a, uint32_t b) { return a - _uqsub8(a, b); }
+static inline uint32_t _vmax(uint32_t a, uint32_t b) { return b + _uqsub8(a, b); }
+
+static inline uint32_t _vmed3(uint32_t a, uint32_t b, uint32_t c)
+{
+    return _vmax(_vmin(a, b), _vmin(_vmax(a, b), c));
+}
+
+static inline uint32_t _ld32(const uint8_t *p)
+{
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+// 5 elemanlık optimal ağ (9 karşılaştırma)
+static inline void _vsort5(uint32_t *v)
+{
+    _VCE(v[0], v[1]); _VCE(v[3], v[4]); _VCE(v[2], v[4]);
+    _VCE(v[2], v[3]); _VCE(v[0], v[3]); _VCE(v[0], v[2]);
+    _VCE(v[1], v[4]); _VCE(v[1], v[3]); _VCE(v[1], v[2]);
+}
+
+// Unutkan seçim: n (tek) değerin medyanı. İlk (n+1)/2+1 değer alınır, her
+// turda min ve max atılıp sıradaki değer eklenir; son üçlünün ortancası.
+static uint32_t _vmedian_forget(uint32_t *v, int n)
+{
+    int lo = 0, hi = (n + 1) / 2;
+    int next = hi + 1;
+
+    while (next < n)
+    {
+        _VCE(v[lo], v[hi]);
+        for (int i = lo + 1; i < hi; i++)
+        {
+            _VCE(v[lo], v[i]);
+            _VCE(v[i], v[hi]);
+        }
+        lo++;
+        v[hi] = v[next++];
+    }
+    return _vmed3(v[lo], v[lo + 1], v[lo + 2]);
+}
+
+#define _MED_PAD	8   // sol/sağ kenar uzatması + kelime okuma payı
+
+// Satırı kenarları kopyalanmış şekilde r piksel içeri kaydırarak yükler
+static void _med_load_row(const uint8_t *src, uint8_t *line, int w, int r)
+{
+    memcpy(line + r, src, (size_t)w);
+    for (int i = 0; i < r; i++)
+    {
+        line[i] = src[0];
+        line[r + w + i] = src[w - 1];
+    }
+}
+
+static int8_t _median(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst, int r)
+{
+    if (!src || !dst || !src->pData || !dst->pData) return IMAGE_ERROR;
+    if (src->format != IMAGE_FORMAT_GRAYSCALE || dst->format != IMAGE_FORMAT_GRAYSCALE) return IMAGE_ERROR;
+    if (src->width != dst->width || src->height != dst->height) return IMAGE_ERROR;
+    if (src->width > IMAGE_MAX_LINE) return IMAGE_ERROR;
+    _occ_reset(dst);
+
+    const int w = src->width;
+    const int h = src->height;
+    const int k = 2 * r + 1;
+    const int pw = w + 2 * r;                 // kenarlı satır uzunluğu
+
+    // k satırlık halka (kaynak kopyası, src == dst için), sıralı sütunlar ve
+    // çıkış satırı; ~7 KB olduğu için stack yerine statik
+    static uint8_t rows[5][IMAGE_MAX_LINE + _MED_PAD];
+    static uint8_t col[5][IMAGE_MAX_LINE + _MED_PAD];
+    static uint8_t out[IMAGE_MAX_LINE + _MED_PAD];
+    memset(rows, 0, sizeof(rows));
+    memset(col, 0, sizeof(col));
+
+    // başlangıç: satır -r .. r-1 (üst kenar kopyalanır), y döngüsü r'inci satırı ekler
+    for (int i = 0; i < k - 1; i++)
+    {
+        int sy = i - r;
+        if (sy < 0) sy = 0;
+        if (sy > h - 1) sy = h - 1;
+        _med_load_row(src->pData + (uint32_t)sy * w, rows[i], w, r);
+    }
+
+    for (int y = 0; y < h; y++)
+    {
+        int sy = y + r;
+        if (sy > h - 1) sy = h - 1;
+        _med_load_row(src->pData + (uint32_t)sy * w, rows[(y + k - 1) % k], w, r);
+
+        // dikey: her sütun bir kez sıralanır
+        for (int x = 0; x < pw; x += 4)
+        {
+            uint32_t v[5];
+            for (int i = 0; i < k; i++) v[i] = _ld32(&rows[(y + i) % k][x]);
+
+            if (k == 3)
+            {
+                _VCE(v[0], v[1]); _VCE(v[1], v[2]); _VCE(v[0], v[1]);
+            }
+            else
+            {
+                _vsort5(v);
+            }
+            for (int i = 0; i < k; i++) memcpy(&col[i][x], &v[i], 4);
+        }
+
+        // yatay: 4 çıkış pikseli birden
+        for (int x = 0; x < w; x += 4)
+        {
+            uint32_t m;
+
+            if (k == 3)
+            {
+                const uint32_t a = _vmax(_vmax(_ld32(&col[0][x]), _ld32(&col[0][x + 1])), _ld32(&col[0][x + 2]));
+                const uint32_t b = _vmed3(_ld32(&col[1][x]), _ld32(&col[1][x + 1]), _ld32(&col[1][x + 2]));
+                const uint32_t c = _vmin(_vmin(_ld32(&col[2][x]), _ld32(&col[2][x + 1])), _ld32(&col[2][x + 2]));
+                m = _vmed3(a, b, c);
+            }
+            else
+            {
+                // sütunlar sıralıyken her sıra düzeyi de sıralanınca matris iki
+                // yönde sıralı olur; (i+1)(j+1) <= 13 ve (5-i)(5-j) <= 13 olan 13
+                // aday kalır, altında ve üstünde 6'şar eleman elenir.
+                uint32_t t[5][5];
+                for (int i = 0; i < 5; i++)
+                {
+                    for (int j = 0; j < 5; j++) t[i][j] = _ld32(&col[i][x + j]);
+                    _vsort5(t[i]);
+                }
+                uint32_t c[13] = {
+                    t[0][3], t[0][4], t[1][2], t[1][3], t[1][4], t[2][1], t[2][2],
+                    t[2][3], t[3][0], t[3][1], t[3][2], t[4][0], t[4][1],
+                };
+                m = _vmedian_forget(c, 13);
+            }
+            memcpy(&out[x], &m, 4);
+        }
+        memcpy(dst->pData + (uint32_t)y * w, out, (size_t)w);
+    }
+
+    return IMAGE_OK;
+}
+
+// dst = 3x3 medyan (kenar kopyalanır), src == dst olabilir
+int8_t IMAGE_Median3x3(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst)
+{
+    return _median(src, dst, 1);
+}
+
+// dst = 5x5 medyan (kenar kopyalanır), src == dst olabilir
+int8_t IMAGE_Median5x5(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst)
+{
+    return _median(src, dst, 2);
+}
+
+/* ---------------------------------------------------------------------------
+ * Büyük pencereler için O(1) rank (medyan/yüzdelik) filtresi, Perreault-
+ * Hébert: her sütunun kh satırlık histogramı tutulur ve satır ilerledikçe
+ * yalnızca giren ve çıkan piksel güncellenir. Çekirdek histogramı kaba
+ * (16 kutu) ve ince (16 x 16) iki seviyelidir; kaba seviye her adımda sütun
+ * farkıyla, ince seviye yalnızca aranan kaba kutu için ve gerektiğinde
+ * (tembel) güncellenir. Sütun histogramları bellek için _RANK_COLS genişliğinde
+ * dikey şeritlerde tutulur. Çerçeve kenarı kopyalanarak uzatılır.
+ * ------------------------------------------------------------------------- */
+
+#define _RANK_COLS		64      // şerit başına sütun histogramı (çıkış + kw-1 kenar)
+
+static uint8_t  _rk_fine[_RANK_COLS][256];   // sayımlar <= kh <= IMAGE_RANK_MAX_WIN
+static uint8_t  _rk_coarse[_RANK_COLS][16];
+
+static inline void _rk_col_update(int c, uint8_t v, int add)
+{
+    if (add) { _rk_fine[c][v]++; _rk_coarse[c][v >> 4]++; }
+    else     { _rk_fine[c][v]--; _rk_coarse[c][v >> 4]--; }
+}
+
+static inline int _clamp_idx(int v, int n)
+{
+    return (v < 0) ? 0 : ((v > n - 1) ? n - 1 : v);
+}
+
+/**
+  * @brief  Rank filter: dst = pct-th percentile (0 = min, 50 = median, 100 = max)
+  *         of the kw x kh window around each pixel; frame edges are replicated.
+  * @note   GRAYSCALE only, kw and kh up to IMAGE_RANK_MAX_WIN. Cost per pixel
+  *         does not grow with the window. src and dst must not share a buffer.
+  */
+int8_t IMAGE_RankFilter(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst, uint16_t kw, uint16_t kh, uint8_t pct)
+{
+    if (!src || !dst || !src->pData || !dst->pData) return IMAGE_ERROR;
+    if (src->format != IMAGE_FORMAT_GRAYSCALE || dst->format != IMAGE_FORMAT_GRAYSCALE) return IMAGE_ERROR;
+    if (src->width != dst->width || src->height != dst->height) return IMAGE_ERROR;
+    if (kw == 0 || kh == 0 || kw > IMAGE_RANK_MAX_WIN || kh > IMAGE_RANK_MAX_WIN || pct > 100) return IMAGE_ERROR;
+    // komşu şeridin kenar sütunları kaynaktan okunur, yerinde çalışamaz
+    if (src->pData == dst->pData) return IMAGE_ERROR;
+    _occ_reset(dst);
+
+    const int w = src->width;
+    const int h = src->height;
+    const int rx = kw / 2;
+    const int ry = kh / 2, sy = kh - 1 - ry;
+    const uint8_t *in = src->pData;
+    const uint16_t rank = (uint16_t)(((uint32_t)kw * kh - 1u) * pct / 100u);
+    const int sw_max = _RANK_COLS - (kw - 1);
+
+    // ~0.9 KB, 1 KB'lık stack yerine statik
+    static uint16_t kc[16];         // çekirdek kaba histogramı
+    static uint16_t kf[16][16];     // çekirdek ince histogramı, kaba kutu başına
+    static int luc[16];             // ince kutu b'nin geçerli olduğu pencere başı
+    static int cx[_RANK_COLS];      // yerel sütun -> görüntü sütunu
+
+    for (int x0 = 0; x0 < w; x0 += sw_max)
+    {
+        const int sw = (w - x0 < sw_max) ? w - x0 : sw_max;
+        const int nc = sw + kw - 1;
+        for (int c = 0; c < nc; c++) cx[c] = _clamp_idx(x0 - rx + c, w);
+
+        memset(_rk_fine, 0, (size_t)nc * sizeof(_rk_fine[0]));
+        memset(_rk_coarse, 0, (size_t)nc * sizeof(_rk_coarse[0]));
+        for (int d = -ry; d <= sy; d++)
+        {
+            const uint8_t *row = in + (uint32_t)_clamp_idx(d, h) * w;
+            for (int c = 0; c < nc; c++) _rk_col_update(c, row[cx[c]], 1);
+        }
+
+        for (int y = 0; y < h; y++)
+        {
+            if (y > 0)
+            {
+                const uint8_t *rout = in + (uint32_t)_clamp_idx(y - 1 - ry, h) * w;
+                const uint8_t *rin  = in + (uint32_t)_clamp_idx(y + sy, h) * w;
+                for (int c = 0; c < nc; c++)
+                {
+                    _rk_col_update(c, rout[cx[c]], 0);
+                    _rk_col_update(c, rin[cx[c]], 1);
+                }
+            }
+
+            memset(kc, 0, sizeof(kc));
+            for (int c = 0; c < kw; c++)
+                for (int b = 0; b < 16; b++) kc[b] += _rk_coarse[c][b];
+            for (int b = 0; b < 16; b++) luc[b] = -(int)kw;   // ince seviye geçersiz
+
+            uint8_t *out = dst->pData + (uint32_t)y * w + x0;
+
+            for (int s = 0; s < sw; s++)
+            {
+                if (s > 0)
+                    for (int b = 0; b < 16; b++)
+                        kc[b] = (uint16_t)(kc[b] + _rk_coarse[s + kw - 1][b] - _rk_coarse[s - 1][b]);
+
+                // kaba kutu
+                int b = 0;
+                uint16_t acc = 0;
+                while (acc + kc[b] <= rank) acc = (uint16_t)(acc + kc[b++]);
+
+                // ince kutu b'yi bu pencereye getir
+                uint16_t *f = kf[b];
+                if (luc[b] + (int)kw <= s)
+                {
+                    memset(f, 0, 16u * sizeof(uint16_t));
+                    for (int c = s; c < s + kw; c++)
+                        for (int i = 0; i < 16; i++) f[i] += _rk_fine[c][(b << 4) + i];
+                }
+                else
+                {
+                    for (int c = luc[b]; c < s; c++)
+                        for (int i = 0; i < 16; i++)
+                            f[i] = (uint16_t)(f[i] + _rk_fine[c + kw][(b << 4) + i] - _rk_fine[c][(b << 4) + i]);
+                }
+                luc[b] = s;
+
+                int i = 0;
+                while (acc + f[i] <= rank) acc = (uint16_t)(acc + f[i++]);
+                out[s] = (uint8_t)((b << 4) + i);
+            }
+        }
+    }
+
+    return IMAGE_OK;
+}
+
+// dst = kw x kh medyan; 3x3 ve 5x5 sıralama ağına, büyükleri rank filtresine gider
+int8_t IMAGE_MedianFilter(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst, uint16_t kw, uint16_t kh)
+{
+    if (kw == 3 && kh == 3) return IMAGE_Median3x3(src, dst);
+    if (kw == 5 && kh == 5) return IMAGE_Median5x5(src, dst);
+    return IMAGE_RankFilter(src, dst, kw, kh, 50);
+}
+
+/* ---------------------------------------------------------------------------
+ * Kutu (ortalama) filtresi, herhangi bir kw x kh pencere. Ayrıştırılabilir:
+ * sütun toplamları satır satır kaydırılır (giren satır eklenir, çıkan
+ * çıkarılır), satır içinde de aynı kayan toplam kullanılır; piksel başına iş
+ * pencereden bağımsızdır. Bölme yerine bir kez hesaplanan sabit noktalı ters
+ * sayı ile çarpılır: m = floor(2^s / N) + 1, s = 31 + ceil(log2 N) seçilince
+ * m 32 bite sığar ve 255 * N < 2^31 için floor(x / N) == (x * m) >> s tamdır.
+ * Çerçeve kenarı kopyalanarak uzatılır, böylece N her pikselde aynıdır.
+ * ------------------------------------------------------------------------- */
+
+static uint32_t _box_col[IMAGE_MAX_LINE];
+
+/**
+  * @brief  dst = floor(mean) of the kw x kh window around each pixel.
+  * @note   GRAYSCALE only, kw * kh < 2^23. Frame edges are replicated.
+  *         src and dst must not share a buffer.
+  */
+int8_t IMAGE_BoxFilter(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst, uint16_t kw, uint16_t kh)
+{
+    if (!src || !dst || !src->pData || !dst->pData) return IMAGE_ERROR;
+    if (src->format != IMAGE_FORMAT_GRAYSCALE || dst->format != IMAGE_FORMAT_GRAYSCALE) return IMAGE_ERROR;
+    if (src->width != dst->width || src->height != dst->height) return IMAGE_ERROR;
+    if (src->width > IMAGE_MAX_LINE || kw == 0 || kh == 0) return IMAGE_ERROR;
+    if ((uint32_t)kw * kh >= (1u << 23)) return IMAGE_ERROR;
+    // çıkan satır hâlâ okunduğu için yerinde çalışamaz
+    if (src->pData == dst->pData) return IMAGE_ERROR;
+    _occ_reset(dst);
+
+    const int w = src->width;
+    const int h = src->height;
+    const int rx = kw / 2, sx = kw - 1 - rx;
+    const int ry = kh / 2, sy = kh - 1 - ry;
+    const uint8_t *in = src->pData;
+
+    const uint32_t N = (uint32_t)kw * kh;
+    int L = 0;
+    while ((1u << L) < N) L++;
+    const int s = 31 + L;
+    const uint32_t m = (uint32_t)(((uint64_t)1 << s) / N + 1u);
+
+    memset(_box_col, 0, (size_t)w * sizeof(_box_col[0]));
+    for (int d = -ry; d <= sy; d++)
+    {
+        const uint8_t *row = in + (uint32_t)_clamp_idx(d, h) * w;
+        for (int x = 0; x < w; x++) _box_col[x] += row[x];
+    }
+
+    for (int y = 0; y < h; y++)
+    {
+        if (y > 0)
+        {
+            const uint8_t *rout = in + (uint32_t)_clamp_idx(y - 1 - ry, h) * w;
+            const uint8_t *rin  = in + (uint32_t)_clamp_idx(y + sy, h) * w;
+            for (int x = 0; x < w; x++) _box_col[x] += (uint32_t)rin[x] - rout[x];
+        }
+
+        uint32_t S = 0;
+        for (int d = -rx; d <= sx; d++) S += _box_col[_clamp_idx(d, w)];
+
+        uint8_t *out = dst->pData + (uint32_t)y * w;
+        for (int x = 0; x < w; x++)
+        {
+            if (x > 0) S += _box_col[_clamp_idx(x + sx, w)] - _box_col[_clamp_idx(x - 1 - rx, w)];
+            out[x] = (uint8_t)(((uint64_t)S * m) >> s);
+        }
+    }
+
+    return IMAGE_OK;
+}
+
+/* ---------------------------------------------------------------------------
+ * IMAGE_FORMAT_BINARY1: 1 bit / piksel. Her satır IMAGE_BINARY1_WORDS(width)
+ * adet 32-bit kelime, x. piksel (x>>5). kelimenin (x&31). biti (LSB = sol).
+ * Satır sonundaki dolgu bitleri her zaman 0 tutulur.
+ * ------------------------------------------------------------------------- */
+
+static inline uint32_t _b1_last_mask(int w)
+{
+    return (w & 31) ? ((1u << (w & 31)) - 1u) : 0xFFFFFFFFu;
+}
+
+static inline uint8_t _b1_check_pair(const IMAGE_HandleTypeDef *src, const IMAGE_HandleTypeDef *dst,
+                                     IMAGE_Format src_fmt, IMAGE_Format dst_fmt)
+{
+    if (!src || !dst || !src->pData || !dst->pData) return 0;
+    if (src->format != src_fmt || dst->format != dst_fmt) return 0;
+    if (src->width != dst->width || src->height != dst->height) return 0;
+    if (src->width > IMAGE_MAX_LINE) return 0;
+    if (((uintptr_t)src->pData & 3u) || ((uintptr_t)dst->pData & 3u)) return 0;
+    return 1;
+}
+
+// 0/255 grayscale -> BINARY1 (255 olan pikseller 1, diğerleri 0)
+int8_t IMAGE_PackBinary(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst)
+{
+    if (!src || !dst || !src->pData || !dst->pData) return IMAGE_ERROR;
+    if (src->format != IMAGE_FORMAT_GRAYSCALE || dst->format != IMAGE_FORMAT_BINARY1) return IMAGE_ERROR;
+    if (src->width != dst->width || src->height != dst->height) return IMAGE_ERROR;
+    if ((uintptr_t)dst->pData & 3u) return IMAGE_ERROR;
+
+    const int w = src->width;
+    const int h = src->height;
+    const int nw = (int)IMAGE_BINARY1_WORDS(w);
+    const uint8_t *in = src->pData;
+    uint32_t *out = (uint32_t *)dst->pData;
+
+    for (int y = 0; y < h; y++)
+    {
+        for (int i = 0; i < nw; i++)
+        {
+            int n = w - (i << 5);
+            if (n > 32) n = 32;
+
+            uint32_t word = 0;
+            for (int b = 0; b < n; b++)
+                word |= (uint32_t)(in[b] == 255) << b;
+
+            out[i] = word;
+            in += n;
+        }
+        out += nw;
+    }
+    return IMAGE_OK;
+}
+
+// BINARY1 -> 0/255 grayscale
+int8_t IMAGE_UnpackBinary(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst)
+{
+    if (!src || !dst || !src->pData || !dst->pData) return IMAGE_ERROR;
+    if (src->format != IMAGE_FORMAT_BINARY1 || dst->format != IMAGE_FORMAT_GRAYSCALE) return IMAGE_ERROR;
+    if (src->width != dst->width || src->height != dst->height) return IMAGE_ERROR;
+    if ((uintptr_t)src->pData & 3u) return IMAGE_ERROR;
+    _occ_reset(dst);
+
+    const int w = src->width;
+    const int h = src->height;
+    const int nw = (int)IMAGE_BINARY1_WORDS(w);
+    const uint32_t *in = (const uint32_t *)src->pData;
+    uint8_t *out = dst->pData;
+
+    for (int y = 0; y < h; y++)
+    {
+        for (int i = 0; i < nw; i++)
+        {
+            int n = w - (i << 5);
+            if (n > 32) n = 32;
+
+            uint32_t word = in[i];
+            for (int b = 0; b < n; b++)
+                out[b] = (uint8_t)(0u - ((word >> b) & 1u));
+
+            out += n;
+        }
+        in += nw;
+    }
+    return IMAGE_OK;
+}
+
+// Bir satırın yatay 3'lü OR/AND'i, 32 piksel birden.
+// Komşu kelimeden taşan bit shift ile alınır, satır dışı 0 sayılır.
+static void _b1_row_h3(const uint32_t *row, uint32_t *hrow, int nw, uint32_t last_mask, uint8_t erode)
+{
+    uint32_t prev = 0;
+    uint32_t cur = (nw == 1) ? (row[0] & last_mask) : row[0];
+
+    for (int i = 0; i < nw; i++)
+    {
+        uint32_t next = 0;
+        if (i + 1 < nw) next = (i + 2 == nw) ? (row[i+1] & last_mask) : row[i+1];
+
+        uint32_t l = (cur << 1) | (prev >> 31);
+        uint32_t r = (cur >> 1) | (next << 31);
+        hrow[i] = erode ? (cur & l & r) : (cur | l | r);
+
+        prev = cur;
+        cur = next;
+    }
+    hrow[nw-1] &= last_mask;
+}
+
+// 3x3 on BINARY1. Yatay sonuçlar 3 satırlık halkada tutulur; satır y
+// yazılmadan önce y+1 okunduğu için src == dst de çalışır.
+static void _b1_morph3x3(const uint32_t *in, uint32_t *out, int w, int h, uint8_t erode)
+{
+    const int nw = (int)IMAGE_BINARY1_WORDS(w);
+    const uint32_t last_mask = _b1_last_mask(w);
+    uint32_t ring[3][IMAGE_BINARY1_WORDS(IMAGE_MAX_LINE)];
+
+    _b1_row_h3(in, ring[0], nw, last_mask, erode);
+
+    for (int y = 0; y < h; y++)
+    {
+        const uint32_t *hc = ring[y % 3];
+        const uint32_t *hp = (y > 0) ? ring[(y + 2) % 3] : NULL;
+        const uint32_t *hn = NULL;
+
+        if (y + 1 < h)
+        {
+            _b1_row_h3(in + (y + 1) * nw, ring[(y + 1) % 3], nw, last_mask, erode);
+            hn = ring[(y + 1) % 3];
+        }
+
+        uint32_t *o = out + y * nw;
+        if (erode)
+        {
+            if (!hp || !hn) { memset(o, 0, (size_t)nw * 4u); continue; }
+            for (int i = 0; i < nw; i++) o[i] = hp[i] & hc[i] & hn[i];
+        }
+        else
+        {
+            for (int i = 0; i < nw; i++)
+                o[i] = hc[i] | (hp ? hp[i] : 0u) | (hn ? hn[i] : 0u);
+        }
+    }
+}
+
+// IMAGE_Dilate3x3 ile aynı sonuç, BINARY1 üzerinde
+int8_t IMAGE_DilateBinary3x3(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst)
+{
+    if (!_b1_check_pair(src, dst, IMAGE_FORMAT_BINARY1, IMAGE_FORMAT_BINARY1)) return IMAGE_ERROR;
+    _b1_morph3x3((const uint32_t *)src->pData, (uint32_t *)dst->pData, src->width, src->height, 0);
+    return IMAGE_OK;
+}
+
+// IMAGE_Erode3x3 ile aynı sonuç, BINARY1 üzerinde
+int8_t IMAGE_ErodeBinary3x3(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst)
+{
+    if (!_b1_check_pair(src, dst, IMAGE_FORMAT_BINARY1, IMAGE_FORMAT_BINARY1)) return IMAGE_ERROR;
+    _b1_morph3x3((const uint32_t *)src->pData, (uint32_t *)dst->pData, src->width, src->height, 1);
+    return IMAGE_OK;
+}
+
+// opening = erosion -> dilation, ikinci adım dst üzerinde yerinde (scratch yok)
+int8_t IMAGE_OpeningBinary3x3(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst)
+{
+    if (IMAGE_ErodeBinary3x3(src, dst) != IMAGE_OK) return IMAGE_ERROR;
+    return IMAGE_DilateBinary3x3(dst, dst);
+}
+
+// closing = dilation -> erosion, ikinci adım dst üzerinde yerinde (scratch yok)
+int8_t IMAGE_ClosingBinary3x3(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst)
+{
+    if (IMAGE_DilateBinary3x3(src, dst) != IMAGE_OK) return IMAGE_ERROR;
+    return IMAGE_ErodeBinary3x3(dst, dst);
+}
+
+/* ---------------------------------------------------------------------------
+ * IMAGE_FORMAT_RLE: her satır için uint16 koşu sayısı n, ardından n adet
+ * (x0, x1) uint16 çifti (kapalı aralık, artan sırada, aralarında en az bir
+ * piksel boşluk). Buffer aynen LIB_SERIAL_IMG_Transmit ile gönderilebilir;
+ * img->size kodlanmış uzunluğa güncellenir. Tüm işlemler koşu aralıkları
+ * üzerinde çalışır, maliyet piksel sayısıyla değil kenar sayısıyla büyür.
+ * Çıkış sıralı yazıldığı için src == dst desteklenmez. Bu biçime uymayan ya
+ * da img->size'ı aşan akış IMAGE_ERROR ile reddedilir.
+ * ------------------------------------------------------------------------- */
+
+#define _RLE_MAX_RUNS		((IMAGE_MAX_LINE + 1) / 2)
+
+typedef struct
+{
+    uint16_t n;
+    uint16_t x[2 * _RLE_MAX_RUNS];
+}_RLERow;
+
+typedef enum { _RLE_AND = 0, _RLE_OR = 1, _RLE_XOR = 2 } _RLEOp;
+
+static uint8_t _rle_check(const IMAGE_HandleTypeDef *img)
+{
+    if (!img || !img->pData || img->format != IMAGE_FORMAT_RLE) return 0;
+    if (img->width > IMAGE_MAX_LINE) return 0;
+    if ((uintptr_t)img->pData & 1u) return 0;
+    return 1;
+}
+
+// Akıştan bir satır okur; bozuk satırda 0 döner. Koşular sıralı olmalı,
+// x0 <= x1 < w ve aralarında en az bir arka plan pikseli bulunmalı
+// (kodlayıcının yazdığı biçim). Okuma end'i geçmez.
+static uint8_t _rle_read(const uint16_t **p, const uint16_t *end, _RLERow *row, int w)
+{
+    const uint16_t *s = *p;
+
+    if (s >= end) return 0;
+    const uint16_t n = *s++;
+
+    if (n > (w + 1) / 2 || (uint32_t)(end - s) < 2u * n) return 0;
+
+    int next = 0;   // sıradaki koşunun en küçük başlangıcı
+    for (int i = 0; i < n; i++)
+    {
+        const uint16_t x0 = s[2*i], x1 = s[2*i + 1];
+        if (x0 < next || x0 > x1 || x1 >= w) return 0;
+        next = x1 + 2;
+    }
+    memcpy(row->x, s, (size_t)n * 4u);
+    row->n = n;
+    *p = s + 2u * n;
+    return 1;
+}
+
+static void _rle_write(uint16_t **p, const _RLERow *row)
+{
+    uint16_t *d = *p;
+    *d++ = row->n;
+    memcpy(d, row->x, (size_t)row->n * 4u);
+    *p = d + 2u * row->n;
+}
+
+// İki satırın mantıksal birleşimi, sınır noktaları üzerinde tek tarama
+static void _rle_combine(const _RLERow *a, const _RLERow *b, _RLERow *out, _RLEOp op)
+{
+    const int na = 2 * a->n, nb = 2 * b->n;
+    int ia = 0, ib = 0;
+    uint8_t cur = 0;
+    uint16_t start = 0;
+
+    out->n = 0;
+    while (ia < na || ib < nb)
+    {
+        // tek indeks = bitiş, sınır x1 + 1'dedir
+        const uint16_t pa = (ia < na) ? (uint16_t)(a->x[ia] + (ia & 1)) : 0xFFFF;
+        const uint16_t pb = (ib < nb) ? (uint16_t)(b->x[ib] + (ib & 1)) : 0xFFFF;
+        const uint16_t pos = (pa < pb) ? pa : pb;
+
+        if (pa == pos) ia++;
+        if (pb == pos) ib++;
+
+        const uint8_t in_a = ia & 1, in_b = ib & 1;
+        const uint8_t v = (op == _RLE_AND) ? (in_a & in_b) : (op == _RLE_OR) ? (in_a | in_b) : (in_a ^ in_b);
+
+        if (v == cur) continue;
+        if (v) start = pos;
+        else { out->x[2*out->n] = start; out->x[2*out->n + 1] = (uint16_t)(pos - 1); out->n++; }
+        cur = v;
+    }
+}
+
+// Yatay 3'lü dilate/erode; çerçeve dışı 0
+static void _rle_h3(const _RLERow *in, _RLERow *out, int w, uint8_t erode)
+{
+    out->n = 0;
+    for (int i = 0; i < in->n; i++)
+    {
+        int a = in->x[2*i], b = in->x[2*i + 1];
+
+        if (erode)
+        {
+            if (++a > --b) continue;
+        }
+        else
+        {
+            if (a > 0) a--;
+            if (b < w - 1) b++;
+            // genişleyen koşu bir öncekine değiyorsa birleşir
+            if (out->n && a <= out->x[2*out->n - 1] + 1) { out->x[2*out->n - 1] = (uint16_t)b; continue; }
+        }
+        out->x[2*out->n] = (uint16_t)a;
+        out->x[2*out->n + 1] = (uint16_t)b;
+        out->n++;
+    }
+}
+
+// Üç satırın dikey OR/AND'i. up/down NULL ise satır çerçeve dışındadır.
+static void _rle_v3(const _RLERow *up, const _RLERow *mid, const _RLERow *down,
+                    _RLERow *out, uint8_t erode)
+{
+    static _RLERow t;
+
+    if (erode)
+    {
+        if (!up || !down) { out->n = 0; return; }
+        _rle_combine(up, mid, &t, _RLE_AND);
+        _rle_combine(&t, down, out, _RLE_AND);
+        return;
+    }
+
+    if (!up && !down) { *out = *mid; return; }
+    if (!up || !down) { _rle_combine(mid, up ? up : down, out, _RLE_OR); return; }
+    _rle_combine(up, mid, &t, _RLE_OR);
+    _rle_combine(&t, down, out, _RLE_OR);
+}
+
+static const uint16_t *_rle_end(const IMAGE_HandleTypeDef *img)
+{
+    return (const uint16_t *)img->pData + img->size / 2u;
+}
+
+static uint8_t _rle_check_pair(const IMAGE_HandleTypeDef *src, const IMAGE_HandleTypeDef *dst)
+{
+    if (!_rle_check(src) || !_rle_check(dst)) return 0;
+    if (src->width != dst->width || src->height != dst->height) return 0;
+    if (src->pData == dst->pData) return 0;
+    return 1;
+}
+
+// 3x3 dilate/erode (passes = 1) ya da opening/closing (passes = 2).
+// İlk işlemin satırları 3 satırlık halkada tutulur, ikinci işlem onlardan
+// akar; ara görüntü yazılmaz.
+static int8_t _rle_morph3x3(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst,
+                            uint8_t first_erode, uint8_t passes)
+{
+    if (!_rle_check_pair(src, dst)) return IMAGE_ERROR;
+
+    const int w = src->width;
+    const int h = src->height;
+    const uint16_t *ip = (const uint16_t *)src->pData;
+    const uint16_t *ip_end = _rle_end(src);
+    uint16_t *op = (uint16_t *)dst->pData;
+    const uint8_t e1 = first_erode;
+    const uint8_t e2 = !first_erode;
+
+    static _RLERow h1[3], h2[3];
+    static _RLERow row, mid;
+
+    // t: okunan src satırı, r = t-1: ilk işlemin satırı, y = t-2: çıkış (passes = 2)
+    for (int t = 0; t < h + passes; t++)
+    {
+        if (t < h)
+        {
+            if (!_rle_read(&ip, ip_end, &row, w)) return IMAGE_ERROR;
+            _rle_h3(&row, &h1[t % 3], w, e1);
+        }
+
+        const int r = t - 1;
+        if (r >= 0 && r < h)
+        {
+            _rle_v3((r > 0) ? &h1[(r + 2) % 3] : NULL, &h1[r % 3],
+                    (r + 1 < h) ? &h1[(r + 1) % 3] : NULL, &mid, e1);
+
+            if (passes == 1) { _rle_write(&op, &mid); continue; }
+            _rle_h3(&mid, &h2[r % 3], w, e2);
+        }
+
+        const int y = t - 2;
+        if (passes == 1 || y < 0) continue;
+
+        _rle_v3((y > 0) ? &h2[(y + 2) % 3] : NULL, &h2[y % 3],
+                (y + 1 < h) ? &h2[(y + 1) % 3] : NULL, &mid, e2);
+        _rle_write(&op, &mid);
+    }
+
+    dst->size = (uint32_t)((uint8_t *)op - dst->pData);
+    return IMAGE_OK;
+}
+
+// Gri satırda v > thresh olan piksellerin koşuları
+static void _rle_encode_row(const uint8_t *in, _RLERow *row, int w, uint8_t thresh)
+{
+    int x = 0;
+
+    row->n = 0;
+    while (x < w)
+    {
+        if (in[x] <= thresh) { x++; continue; }
+
+        const int x0 = x;
+        while (x < w && in[x] > thresh) x++;
+
+        row->x[2*row->n] = (uint16_t)x0;
+        row->x[2*row->n + 1] = (uint16_t)(x - 1);
+        row->n++;
+    }
+}
+
+/**
+  * @brief  Threshold a GRAYSCALE image straight into RLE, foreground = pixel > thresh
+  *         (same rule as IMAGE_ApplyThreshold). dst->size is set to the encoded length.
+  * @note   dst buffer must hold IMAGE_RLE_MAX_SIZE(width, height) bytes in the worst case.
+  */
+int8_t IMAGE_ThresholdRLE(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst, uint8_t thresh)
+{
+    if (!src || !src->pData || src->format != IMAGE_FORMAT_GRAYSCALE || !_rle_check(dst)) return IMAGE_ERROR;
+    if (src->width != dst->width || src->height != dst->height) return IMAGE_ERROR;
+    if (src->pData == dst->pData) return IMAGE_ERROR;
+
+    const int w = src->width;
+    uint16_t *op = (uint16_t *)dst->pData;
+    static _RLERow row;
+
+    for (int y = 0; y < src->height; y++)
+    {
+        _rle_encode_row(src->pData + (uint32_t)y * w, &row, w, thresh);
+        _rle_write(&op, &row);
+    }
+
+    dst->size = (uint32_t)((uint8_t *)op - dst->pData);
+    return IMAGE_OK;
+}
+
+// 0/255 grayscale -> RLE (255 olan pikseller ön plan)
+int8_t IMAGE_PackRLE(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst)
+{
+    return IMAGE_ThresholdRLE(src, dst, 254);
+}
+
+// RLE -> 0/255 grayscale
+int8_t IMAGE_UnpackRLE(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst)
+{
+    if (!_rle_check(src) || !dst || !dst->pData || dst->format != IMAGE_FORMAT_GRAYSCALE) return IMAGE_ERROR;
+    if (src->width != dst->width || src->height != dst->height) return IMAGE_ERROR;
+    if (src->pData == dst->pData) return IMAGE_ERROR;
+    _occ_reset(dst);
+
+    const int w = src->width;
+    const uint16_t *ip = (const uint16_t *)src->pData;
+    const uint16_t *ip_end = _rle_end(src);
+    uint8_t *out = dst->pData;
+    static _RLERow row;
+
+    for (int y = 0; y < src->height; y++, out += w)
+    {
+        if (!_rle_read(&ip, ip_end, &row, w)) return IMAGE_ERROR;
+
+        memset(out, 0, (size_t)w);
+        for (int i = 0; i < row.n; i++)
+            memset(out + row.x[2*i], 255, (size_t)(row.x[2*i + 1] - row.x[2*i] + 1));
+    }
+    return IMAGE_OK;
+}
+
+// IMAGE_Dilate3x3 ile aynı sonuç, RLE üzerinde
+int8_t IMAGE_DilateRLE3x3(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst)
+{
+    return _rle_morph3x3(src, dst, 0, 1);
+}
+
+// IMAGE_Erode3x3 ile aynı sonuç, RLE üzerinde
+int8_t IMAGE_ErodeRLE3x3(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst)
+{
+    return _rle_morph3x3(src, dst, 1, 1);
+}
+
+// opening = erosion -> dilation, tek geçişte
+int8_t IMAGE_OpeningRLE3x3(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst)
+{
+    return _rle_morph3x3(src, dst, 1, 2);
+}
+
+// closing = dilation -> erosion, tek geçişte
+int8_t IMAGE_ClosingRLE3x3(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst)
+{
+    return _rle_morph3x3(src, dst, 0, 2);
+}
+
+static int8_t _rle_logic(const IMAGE_HandleTypeDef *a, const IMAGE_HandleTypeDef *b,
+                         IMAGE_HandleTypeDef *dst, _RLEOp op)
+{
+    if (!_rle_check_pair(a, dst) || !_rle_check_pair(b, dst)) return IMAGE_ERROR;
+    if (a->width != b->width || a->height != b->height) return IMAGE_ERROR;
+
+    const int w = a->width;
+    const uint16_t *pa = (const uint16_t *)a->pData;
+    const uint16_t *pb = (const uint16_t *)b->pData;
+    const uint16_t *pa_end = _rle_end(a);
+    const uint16_t *pb_end = _rle_end(b);
+    uint16_t *o = (uint16_t *)dst->pData;
+    static _RLERow ra, rb, ro;   // ~3.9 KB, stack yerine statik
+
+    for (int y = 0; y < a->height; y++)
+    {
+        if (!_rle_read(&pa, pa_end, &ra, w) || !_rle_read(&pb, pb_end, &rb, w)) return IMAGE_ERROR;
+        _rle_combine(&ra, &rb, &ro, op);
+        _rle_write(&o, &ro);
+    }
+
+    dst->size = (uint32_t)((uint8_t *)o - dst->pData);
+    return IMAGE_OK;
+}
+
+// dst = a AND b / a OR b / a XOR b, satır satır koşu aralıkları üzerinde
+int8_t IMAGE_AndRLE(const IMAGE_HandleTypeDef *a, const IMAGE_HandleTypeDef *b, IMAGE_HandleTypeDef *dst)
+{
+    return _rle_logic(a, b, dst, _RLE_AND);
+}
+
+int8_t IMAGE_OrRLE(const IMAGE_HandleTypeDef *a, const IMAGE_HandleTypeDef *b, IMAGE_HandleTypeDef *dst)
+{
+    return _rle_logic(a, b, dst, _RLE_OR);
+}
+
+int8_t IMAGE_XorRLE(const IMAGE_HandleTypeDef *a, const IMAGE_HandleTypeDef *b, IMAGE_HandleTypeDef *dst)
+{
+    return _rle_logic(a, b, dst, _RLE_XOR);
+}
+
+/* ---------------------------------------------------------------------------
+ * Yapısal eleman (structuring element) motoru. Maske bir kez satır
+ * koşularına (dy, dx, len) derlenir; IMAGE_Morph her koşuyu satırın önek
+ * toplamından tek çıkarmayla test eder. Piksel başına maliyet koşu sayısı
+ * kadardır, maskenin alanıyla büyümez ve iç döngüde maske biti okunmaz.
+ * ------------------------------------------------------------------------- */
+
+#define _SE_PAD			(IMAGE_SE_MAX_SIZE)
+#define _SE_PREFIX_LEN	(IMAGE_MAX_LINE + 2 * _SE_PAD + 1)
+
+// width x height maske (0 olmayan = eleman), çapa ortada (width/2, height/2)
+int8_t IMAGE_SE_FromMask(IMAGE_StructElemTypeDef *se, const uint8_t *mask, uint8_t width, uint8_t height)
+{
+    __LIB_IMAGE_CHECK_PARAM(se);
+    __LIB_IMAGE_CHECK_PARAM(mask);
+    __LIB_IMAGE_CHECK_PARAM(width);
+    __LIB_IMAGE_CHECK_PARAM(height);
+    if (width > IMAGE_SE_MAX_SIZE || height > IMAGE_SE_MAX_SIZE) return IMAGE_ERROR;
+
+    se->width  = width;
+    se->height = height;
+    se->cx     = width / 2;
+    se->cy     = height / 2;
+    se->nruns  = 0;
+
+    for (int j = 0; j < height; j++)
+    {
+        const uint8_t *row = mask + j * width;
+        int i = 0;
+
+        while (i < width)
+        {
+            if (!row[i]) { i++; continue; }
+
+            int i0 = i;
+            while (i < width && row[i]) i++;
+
+            IMAGE_SERunTypeDef *run = &se->runs[se->nruns++];
+            run->dy  = (int8_t)(j - se->cy);
+            run->dx  = (int8_t)(i0 - se->cx);
+            run->len = (uint8_t)(i - i0);
+        }
+    }
+
+    return (se->nruns != 0) ? IMAGE_OK : IMAGE_ERROR;
+}
+
+int8_t IMAGE_SE_Rect(IMAGE_StructElemTypeDef *se, uint8_t width, uint8_t height)
+{
+    uint8_t mask[IMAGE_SE_MAX_SIZE * IMAGE_SE_MAX_SIZE];
+
+    if (width > IMAGE_SE_MAX_SIZE || height > IMAGE_SE_MAX_SIZE) return IMAGE_ERROR;
+    memset(mask, 1, (size_t)width * height);
+    return IMAGE_SE_FromMask(se, mask, width, height);
+}
+
+// size x size artı işareti
+int8_t IMAGE_SE_Cross(IMAGE_StructElemTypeDef *se, uint8_t size)
+{
+    uint8_t mask[IMAGE_SE_MAX_SIZE * IMAGE_SE_MAX_SIZE] = {0};
+
+    if (size > IMAGE_SE_MAX_SIZE) return IMAGE_ERROR;
+    for (int i = 0; i < size; i++)
+    {
+        mask[(size / 2) * size + i] = 1;
+        mask[i * size + size / 2]   = 1;
+    }
+    return IMAGE_SE_FromMask(se, mask, size, size);
+}
+
+// |dx| + |dy| <= radius
+int8_t IMAGE_SE_Diamond(IMAGE_StructElemTypeDef *se, uint8_t radius)
+{
+    uint8_t mask[IMAGE_SE_MAX_SIZE * IMAGE_SE_MAX_SIZE];
+    const int r = radius;
+    const int n = 2 * r + 1;
+
+    if (n > IMAGE_SE_MAX_SIZE) return IMAGE_ERROR;
+    for (int j = 0; j < n; j++)
+        for (int i = 0; i < n; i++)
+            mask[j * n + i] = (abs(i - r) + abs(j - r) <= r);
+    return IMAGE_SE_FromMask(se, mask, (uint8_t)n, (uint8_t)n);
+}
+
+// dx^2 + dy^2 <= radius^2
+int8_t IMAGE_SE_Disk(IMAGE_StructElemTypeDef *se, uint8_t radius)
+{
+    uint8_t mask[IMAGE_SE_MAX_SIZE * IMAGE_SE_MAX_SIZE];
+    const int r = radius;
+    const int n = 2 * r + 1;
+
+    if (n > IMAGE_SE_MAX_SIZE) return IMAGE_ERROR;
+    for (int j = 0; j < n; j++)
+        for (int i = 0; i < n; i++)
+            mask[j * n + i] = ((i - r) * (i - r) + (j - r) * (j - r) <= r * r);
+    return IMAGE_SE_FromMask(se, mask, (uint8_t)n, (uint8_t)n);
+}
+
+// Çapadan geçen, x ekseninden saat yönünün tersine angle_deg derece
+// eğimli, yaklaşık length piksel uzunluğunda Bresenham doğrusu
+int8_t IMAGE_SE_Line(IMAGE_StructElemTypeDef *se, uint8_t length, int16_t angle_deg)
+{
+    uint8_t mask[IMAGE_SE_MAX_SIZE * IMAGE_SE_MAX_SIZE] = {0};
+
+    if (length == 0 || length > IMAGE_SE_MAX_SIZE) return IMAGE_ERROR;
+
+    const int half = (length - 1) / 2;
+    const int n = 2 * half + 1;
+    const float a = (float)angle_deg * 0.0174532925f;
+    const int ex = (int)lroundf((float)half * cosf(a));
+    const int ey = -(int)lroundf((float)half * sinf(a));
+
+    int x = -ex, y = -ey;
+    const int dx = abs(2 * ex), sx = (ex > 0) ? 1 : -1;
+    const int dy = -abs(2 * ey), sy = (ey > 0) ? 1 : -1;
+    int err = dx + dy;
+
+    for (;;)
+    {
+        mask[(y + half) * n + (x + half)] = 1;
+        if (x == ex && y == ey) break;
+
+        int e2 = 2 * err;
+        if (e2 >= dy) { err += dy; x += sx; }
+        if (e2 <= dx) { err += dx; y += sy; }
+    }
+    return IMAGE_SE_FromMask(se, mask, (uint8_t)n, (uint8_t)n);
+}
+
+// Bir src satırının önek sayımı: P[p] = [0, p) aralığındaki 255 sayısı,
+// p = x + _SE_PAD. uint8_t ile taşma sorun değil, koşu boyu <= 15 olduğu
+// için fark mod 256 hâlâ doğru.
+static void _se_row_prefix(const uint8_t *row, uint8_t *P, int w)
+{
+    uint8_t acc = 0;
+    int p = 0;
+
+    for (; p <= _SE_PAD; p++) P[p] = 0;
+    for (int x = 0; x < w; x++, p++)
+    {
+        acc += (row[x] == 255);
+        P[p] = acc;
+    }
+    for (; p < w + 2 * _SE_PAD + 1; p++) P[p] = acc;
+}
+
+// Önek satır halkası (~10 KB) ve koşu satır işaretçileri; yığına sığmaz
+static uint8_t        _se_ring[IMAGE_SE_MAX_SIZE][_SE_PREFIX_LEN];
+static const uint8_t *_se_rp[IMAGE_SE_MAX_RUNS];
+
+// Tek erozyon/dilatasyon geçişi. Erozyon: (x + d) noktalarının hepsi 255;
+// dilatasyon: yansıtılmış eleman ile (x - d) noktalarından biri 255.
+// Çıkış satırı y, src satırı y + dymax (>= y) okunduktan sonra yazılır,
+// bu yüzden in == out güvenlidir.
+static void _se_pass(const uint8_t *in, uint8_t *out, int w, int h,
+                     const IMAGE_StructElemTypeDef *se, uint8_t erode)
+{
+    static const uint8_t zero_row[_SE_PREFIX_LEN] = {0};
+    int8_t  rdy[IMAGE_SE_MAX_RUNS];
+    uint8_t ra[IMAGE_SE_MAX_RUNS], rb[IMAGE_SE_MAX_RUNS], rlen[IMAGE_SE_MAX_RUNS];
+    const int nr = se->nruns;
+
+    for (int k = 0; k < nr; k++)
+    {
+        const IMAGE_SERunTypeDef *run = &se->runs[k];
+        int dy = run->dy, dx = run->dx;
+
+        if (!erode) { dy = -dy; dx = -(dx + run->len - 1); }
+
+        rdy[k]  = (int8_t)dy;
+        ra[k]   = (uint8_t)(dx + _SE_PAD);
+        rb[k]   = (uint8_t)(dx + _SE_PAD + run->len);
+        rlen[k] = run->len;
+    }
+
+    const int dymax = erode ? (se->height - 1 - se->cy) : se->cy;
+    int loaded = 0;
+
+    for (int y = 0; y < h; y++)
+    {
+        int last = y + dymax;
+        if (last > h - 1) last = h - 1;
+        for (; loaded <= last; loaded++)
+            _se_row_prefix(in + loaded * w, _se_ring[loaded % IMAGE_SE_MAX_SIZE], w);
+
+        for (int k = 0; k < nr; k++)
+        {
+            int r = y + rdy[k];
+            _se_rp[k] = (r < 0 || r >= h) ? zero_row : _se_ring[r % IMAGE_SE_MAX_SIZE];
+        }
+
+        uint8_t *o = out + y * w;
+        if (erode)
+        {
+            for (int x = 0; x < w; x++)
+            {
+                uint8_t v = 255;
+                for (int k = 0; k < nr; k++)
+                {
+                    if ((uint8_t)(_se_rp[k][x + rb[k]] - _se_rp[k][x + ra[k]]) != rlen[k]) { v = 0; break; }
+                }
+                o[x] = v;
+            }
+        }
+        else
+        {
+            for (int x = 0; x < w; x++)
+            {
+                uint8_t v = 0;
+                for (int k = 0; k < nr; k++)
+                {
+                    if (_se_rp[k][x + rb[k]] != _se_rp[k][x + ra[k]]) { v = 255; break; }
+                }
+                o[x] = v;
+            }
+        }
+    }
+}
+
+// Dışarıdan doldurulmuş SE de geçebileceği için her koşu bildirilen kutu
+// içinde olmalı; aksi halde ra/rb taşar ya da yüklenmemiş halka satırı okunur.
+static int8_t _se_check(const IMAGE_StructElemTypeDef *se)
+{
+    if (se->width == 0 || se->height == 0) return IMAGE_ERROR;
+    if (se->width > IMAGE_SE_MAX_SIZE || se->height > IMAGE_SE_MAX_SIZE) return IMAGE_ERROR;
+    if (se->cx >= se->width || se->cy >= se->height) return IMAGE_ERROR;
+    if (se->nruns == 0 || se->nruns > IMAGE_SE_MAX_RUNS) return IMAGE_ERROR;
+
+    for (int k = 0; k < se->nruns; k++)
+    {
+        const IMAGE_SERunTypeDef *run = &se->runs[k];
+
+        if (run->len == 0) return IMAGE_ERROR;
+        if (run->dx < -(int)se->cx || run->dx + run->len > se->width - se->cx) return IMAGE_ERROR;
+        if (run->dy < -(int)se->cy || run->dy > se->height - 1 - se->cy) return IMAGE_ERROR;
+    }
+    return IMAGE_OK;
+}
+
+// Genel ikili morfoloji, sınır dışı 0. OPEN/CLOSE'un ikinci adımı dst
+// üzerinde yerinde çalışır, src == dst olabilir.
+int8_t IMAGE_Morph(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst, const IMAGE_StructElemTypeDef *se, IMAGE_MorphOp op)
+{
+    if (!src || !dst || !se || !src->pData || !dst->pData) return IMAGE_ERROR;
+    if (src->format != IMAGE_FORMAT_GRAYSCALE || dst->format != IMAGE_FORMAT_GRAYSCALE) return IMAGE_ERROR;
+    if (src->width != dst->width || src->height != dst->height) return IMAGE_ERROR;
+    if (src->width > IMAGE_MAX_LINE) return IMAGE_ERROR;
+    if (_se_check(se) != IMAGE_OK) return IMAGE_ERROR;
+    _occ_reset(dst);
+
+    const int w = src->width;
+    const int h = src->height;
+
+    switch (op)
+    {
+    case IMAGE_MORPH_DILATE:
+        _se_pass(src->pData, dst->pData, w, h, se, 0);
+        break;
+    case IMAGE_MORPH_ERODE:
+        _se_pass(src->pData, dst->pData, w, h, se, 1);
+        break;
+    case IMAGE_MORPH_OPEN:
+        _se_pass(src->pData, dst->pData, w, h, se, 1);
+        _se_pass(dst->pData, dst->pData, w, h, se, 0);
+        break;
+    case IMAGE_MORPH_CLOSE:
+        _se_pass(src->pData, dst->pData, w, h, se, 0);
+        _se_pass(dst->pData, dst->pData, w, h, se, 1);
+        break;
+    default:
+        return IMAGE_ERROR;
+    }
+    return IMAGE_OK;
+}
+
+/* ---------------------------------------------------------------------------
+ * Bağlı bileşen etiketleme (8-komşuluk), satır koşuları üzerinde union-find.
+ * Yalnızca önceki ve şimdiki satırın koşuları ile açık bileşenlerin sınırlı
+ * denklik tablosu tutulur; etiket görüntüsü yoktur. Bir bileşen, koşusu
+ * olmayan ilk satırda tamamlanır, istatistiği yazılır ve etiketi geri
+ * kazanılır. Çevre 4-komşu kenar sayısıdır (arka plana/çerçeve dışına
+ * bakan piksel kenarları).
+ * ------------------------------------------------------------------------- */
+
+#define _BLOB_MAX_RUNS		(IMAGE_MAX_LINE / 2 + 1)
+
+typedef struct
+{
+    uint16_t x0, x1;
+    uint16_t label;
+    uint16_t ov;        // alt/üst satırla tam (4-komşu) örtüşen piksel sayısı
+}_BlobRun;
+
+typedef struct
+{
+    uint16_t parent;
+    uint16_t x_min, x_max, y_min, y_max;
+    uint16_t seen;      // son görüldüğü satır + 1
+    uint32_t area, sum_x, sum_y, perimeter;
+}_BlobAcc;
+
+typedef struct
+{
+    _BlobAcc acc[IMAGE_BLOB_MAX_OPEN];
+    uint16_t free_list[IMAGE_BLOB_MAX_OPEN];
+    uint16_t nfree;
+    uint16_t merged[IMAGE_BLOB_MAX_OPEN];
+    uint16_t nmerged;
+    IMAGE_BlobTypeDef *out;
+    uint16_t max_out;
+    uint16_t count;
+}_BlobCtx;
+
+static uint16_t _blob_find(_BlobCtx *ctx, uint16_t l)
+{
+    uint16_t r = l;
+    while (ctx->acc[r].parent != r) r = ctx->acc[r].parent;
+    while (ctx->acc[l].parent != r)
+    {
+        uint16_t n = ctx->acc[l].parent;
+        ctx->acc[l].parent = r;
+        l = n;
+    }
+    return r;
+}
+
+static void _blob_union(_BlobCtx *ctx, uint16_t a, uint16_t b)
+{
+    a = _blob_find(ctx, a);
+    b = _blob_find(ctx, b);
+    if (a == b) return;
+
+    _BlobAcc *ra = &ctx->acc[a];
+    const _BlobAcc *rb = &ctx->acc[b];
+
+    ra->area += rb->area;
+    ra->sum_x += rb->sum_x;
+    ra->sum_y += rb->sum_y;
+    ra->perimeter += rb->perimeter;
+    if (rb->x_min < ra->x_min) ra->x_min = rb->x_min;
+    if (rb->x_max > ra->x_max) ra->x_max = rb->x_max;
+    if (rb->y_min < ra->y_min) ra->y_min = rb->y_min;
+    if (rb->y_max > ra->y_max) ra->y_max = rb->y_max;
+
+    ctx->acc[b].parent = a;
+    ctx->merged[ctx->nmerged++] = b;   // satır sonunda serbest bırakılır
+}
+
+static void _blob_emit(_BlobCtx *ctx, uint16_t l)
+{
+    const _BlobAcc *a = &ctx->acc[l];
+
+    if (ctx->count < ctx->max_out)
+    {
+        IMAGE_BlobTypeDef *b = &ctx->out[ctx->count];
+        b->area      = a->area;
+        b->perimeter = a->perimeter;
+        b->x_min = a->x_min; b->x_max = a->x_max;
+        b->y_min = a->y_min; b->y_max = a->y_max;
+        b->cx = (float)a->sum_x / (float)a->area;
+        b->cy = (float)a->sum_y / (float)a->area;
+    }
+    ctx->count++;
+    ctx->free_list[ctx->nfree++] = l;
+}
+
+// Satır y'nin koşularını çıkarır, koşu sayısını döndürür
+static int _blob_row_runs(const uint8_t *row, int w, _BlobRun *runs)
+{
+    int n = 0;
+    int x = 0;
+
+    while (x < w)
+    {
+        if (row[x] != 255) { x++; continue; }
+
+        int x0 = x;
+        while (x < w && row[x] == 255) x++;
+
+        runs[n].x0 = (uint16_t)x0;
+        runs[n].x1 = (uint16_t)(x - 1);
+        runs[n].ov = 0;
+        n++;
+    }
+    return n;
+}
+
+/**
+  * @brief  Label 8-connected 255-blobs of a binary GRAYSCALE image and return
+  *         area, bounding box, centroid and 4-neighbour perimeter per blob.
+  * @param  blobs      Output records, in completion order (bottom row of each blob)
+  * @param  max_blobs  Capacity of blobs
+  * @param  count      Number of blobs found; may exceed max_blobs, extras are dropped
+  * @retval IMAGE_OK, or IMAGE_ERROR if more than IMAGE_BLOB_MAX_OPEN labels are open at once
+  */
+int8_t IMAGE_LabelBlobs(const IMAGE_HandleTypeDef *img, IMAGE_BlobTypeDef *blobs, uint16_t max_blobs, uint16_t *count)
+{
+    if (!img || !img->pData || !count || (!blobs && max_blobs)) return IMAGE_ERROR;
+    if (img->format != IMAGE_FORMAT_GRAYSCALE) return IMAGE_ERROR;
+    if (img->width > IMAGE_MAX_LINE) return IMAGE_ERROR;
+
+    const int w = img->width;
+    const int h = img->height;
+
+    static _BlobCtx ctx;
+    static _BlobRun rbuf[2][_BLOB_MAX_RUNS];     // ~5 KB, stack yerine statik
+    _BlobRun *prev = rbuf[0], *cur = rbuf[1];
+    int np = 0;
+
+    ctx.out = blobs;
+    ctx.max_out = max_blobs;
+    ctx.count = 0;
+    ctx.nmerged = 0;
+    ctx.nfree = IMAGE_BLOB_MAX_OPEN;
+    for (uint16_t i = 0; i < IMAGE_BLOB_MAX_OPEN; i++)
+        ctx.free_list[i] = (uint16_t)(IMAGE_BLOB_MAX_OPEN - 1 - i);
+
+    *count = 0;
+
+    for (int y = 0; y <= h; y++)
+    {
+        // y == h: boş bir satır gibi davranıp açık bileşenleri kapatır
+        int nc = (y < h) ? _blob_row_runs(img->pData + (uint32_t)y * w, w, cur) : 0;
+
+        // tam örtüşmeler: üst/alt kenar çevresi için
+        for (int i = 0, j = 0; i < np && j < nc; )
+        {
+            int lo = (prev[i].x0 > cur[j].x0) ? prev[i].x0 : cur[j].x0;
+            int hi = (prev[i].x1 < cur[j].x1) ? prev[i].x1 : cur[j].x1;
+            if (hi >= lo)
+            {
+                prev[i].ov += (uint16_t)(hi - lo + 1);
+                cur[j].ov  += (uint16_t)(hi - lo + 1);
+            }
+            if (prev[i].x1 < cur[j].x1) i++; else j++;
+        }
+
+        // 8-komşu bağlantı ve istatistik
+        for (int j = 0, k0 = 0; j < nc; j++)
+        {
+            _BlobRun *c = &cur[j];
+            int label = -1;
+
+            while (k0 < np && prev[k0].x1 + 1 < c->x0) k0++;
+            for (int k = k0; k < np && prev[k].x0 <= c->x1 + 1; k++)
+            {
+                if (label < 0) label = _blob_find(&ctx, prev[k].label);
+                else _blob_union(&ctx, (uint16_t)label, prev[k].label);
+                label = _blob_find(&ctx, (uint16_t)label);
+            }
+
+            if (label < 0)
+            {
+                if (ctx.nfree == 0) return IMAGE_ERROR;
+                label = ctx.free_list[--ctx.nfree];
+
+                _BlobAcc *n = &ctx.acc[label];
+                n->parent = (uint16_t)label;
+                n->x_min = c->x0; n->x_max = c->x1;
+                n->y_min = (uint16_t)y; n->y_max = (uint16_t)y;
+                n->area = 0; n->sum_x = 0; n->sum_y = 0; n->perimeter = 0;
+                n->seen = 0;
+            }
+
+            const uint32_t len = (uint32_t)(c->x1 - c->x0 + 1);
+            _BlobAcc *a = &ctx.acc[label];
+            a->area += len;
+            a->sum_x += (uint32_t)(c->x0 + c->x1) * len / 2u;
+            a->sum_y += (uint32_t)y * len;
+            a->perimeter += 2u + (len - c->ov);
+            if (c->x0 < a->x_min) a->x_min = c->x0;
+            if (c->x1 > a->x_max) a->x_max = c->x1;
+            a->y_max = (uint16_t)y;
+            c->label = (uint16_t)label;
+        }
+
+        // önceki satırın alt kenarları, sonra hangi köklerin devam ettiği
+        for (int k = 0; k < np; k++)
+            ctx.acc[_blob_find(&ctx, prev[k].label)].perimeter += (uint32_t)(prev[k].x1 - prev[k].x0 + 1) - prev[k].ov;
+
+        for (int j = 0; j < nc; j++)
+        {
+            cur[j].label = _blob_find(&ctx, cur[j].label);
+            ctx.acc[cur[j].label].seen = (uint16_t)(y + 1);
+        }
+
+        for (int k = 0; k < np; k++)
+        {
+            uint16_t r = _blob_find(&ctx, prev[k].label);
+            if (ctx.acc[r].seen == (uint16_t)(y + 1)) continue;
+            ctx.acc[r].seen = (uint16_t)(y + 1);
+            _blob_emit(&ctx, r);
+        }
+
+        while (ctx.nmerged) ctx.free_list[ctx.nfree++] = ctx.merged[--ctx.nmerged];
+
+        for (int j = 0; j < nc; j++) cur[j].ov = 0;
+        _BlobRun *t = prev; prev = cur; cur = t;
+        np = nc;
+    }
+
+    *count = ctx.count;
+    return IMAGE_OK;
+}
+
+/* ---------------------------------------------------------------------------
+ * Histerezis eşikleme: > hi "güçlü", > lo "zayıf" piksellerdir; zayıf bir
+ * bileşen (8-komşu) yalnızca güçlü piksel içeriyorsa kalır. Tek geçişte,
+ * bileşen etiketlemedeki gibi koşular üzerinde union-find ile çözülür.
+ * Güçlü olduğu bilinen bileşenin koşuları hemen 255 yazılır; kararsız
+ * koşular 0 bırakılıp bileşene bağlı bekleyen listeye eklenir. Bileşen
+ * sonradan güçlenirse listesi 255 ile boşaltılır, güçlenmeden kapanırsa
+ * liste atılır. Etiket havuzu iki satırın koşularına yeter, taşmaz. Bekleyen
+ * havuz dolarsa kararsız koşular dst'ye geçici _HYST_TENT yazılır; kare
+ * sonunda 255'e 8-komşu bağlı olanlar 255, kalanlar 0 yapılır.
+ * ------------------------------------------------------------------------- */
+
+#define _HYST_NIL		0xFFFFu
+#define _HYST_LABELS	(2 * _BLOB_MAX_RUNS)    // canlı etiket <= önceki + bu satırın koşuları
+#define _HYST_TENT		1u
+
+// Yeniden yapılandırma bölümünde tanımlı (FIFO taşkın doldurma)
+static void _recon_flood_tagged(uint8_t *img, int w, int h, uint8_t from, uint8_t tag, uint8_t conn8);
+
+typedef struct
+{
+    uint16_t x0, x1;
+    uint16_t label;
+    uint8_t  strong;
+}_HystRun;
+
+typedef struct
+{
+    uint16_t y, x0, x1;
+    uint16_t next;
+}_HystPend;
+
+typedef struct
+{
+    uint16_t parent[_HYST_LABELS];
+    uint16_t head[_HYST_LABELS];
+    uint16_t tail[_HYST_LABELS];
+    uint16_t seen[_HYST_LABELS];
+    uint8_t  strong[_HYST_LABELS];
+    uint16_t free_list[_HYST_LABELS];
+    uint16_t nfree;
+    uint16_t merged[_HYST_LABELS];
+    uint16_t nmerged;
+    _HystPend pend[IMAGE_HYST_MAX_PENDING];
+    uint16_t pfree;     // boş bekleyen kayıt zinciri
+    uint8_t  spill;     // bekleyen havuz doldu, geçici koşular var
+    uint8_t *out;
+    uint16_t w;
+}_HystCtx;
+
+static _HystCtx _hy;
+
+static uint16_t _hyst_find(uint16_t l)
+{
+    uint16_t r = l;
+    while (_hy.parent[r] != r) r = _hy.parent[r];
+    while (_hy.parent[l] != r)
+    {
+        uint16_t n = _hy.parent[l];
+        _hy.parent[l] = r;
+        l = n;
+    }
+    return r;
+}
+
+// Kökün bekleyen listesini bırakır; fill ise koşular 255 yazılır
+static void _hyst_drop(uint16_t r, uint8_t fill)
+{
+    uint16_t e = _hy.head[r];
+    while (e != _HYST_NIL)
+    {
+        _HystPend *p = &_hy.pend[e];
+        uint16_t n = p->next;
+        if (fill) memset(_hy.out + (uint32_t)p->y * _hy.w + p->x0, 255, (size_t)(p->x1 - p->x0 + 1));
+        p->next = _hy.pfree;
+        _hy.pfree = e;
+        e = n;
+    }
+    _hy.head[r] = _hy.tail[r] = _HYST_NIL;
+}
+
+static uint16_t _hyst_union(uint16_t a, uint16_t b)
+{
+    a = _hyst_find(a);
+    b = _hyst_find(b);
+    if (a == b) return a;
+
+    if (_hy.head[b] != _HYST_NIL)
+    {
+        if (_hy.head[a] == _HYST_NIL) _hy.head[a] = _hy.head[b];
+        else _hy.pend[_hy.tail[a]].next = _hy.head[b];
+        _hy.tail[a] = _hy.tail[b];
+        _hy.head[b] = _hy.tail[b] = _HYST_NIL;
+    }
+    if (_hy.strong[a] != _hy.strong[b])
+    {
+        _hy.strong[a] = 1;
+        _hyst_drop(a, 1);
+    }
+
+    _hy.parent[b] = a;
+    _hy.merged[_hy.nmerged++] = b;   // satır sonunda serbest bırakılır
+    return a;
+}
+
+static int _hyst_row_runs(const uint8_t *row, int w, uint8_t lo, uint8_t hi, _HystRun *runs)
+{
+    int n = 0;
+    int x = 0;
+
+    while (x < w)
+    {
+        if (row[x] <= lo) { x++; continue; }
+
+        int x0 = x;
+        uint8_t strong = 0;
+        while (x < w && row[x] > lo) { strong |= (row[x] > hi); x++; }
+
+        runs[n].x0 = (uint16_t)x0;
+        runs[n].x1 = (uint16_t)(x - 1);
+        runs[n].strong = strong;
+        n++;
+    }
+    return n;
+}
+
+/**
+  * @brief  Hysteresis threshold of a GRAYSCALE image: pixels > hi are kept,
+  *         pixels > lo are kept only if 8-connected to a pixel > hi. Output 255/0.
+  * @note   Single streaming pass, src == dst is allowed. If more than
+  *         IMAGE_HYST_MAX_PENDING undecided runs are open at once, a final
+  *         flood pass over dst resolves the rest (same result, slower).
+  * @retval IMAGE_OK, or IMAGE_ERROR on invalid arguments (checked before any write)
+  */
+int8_t IMAGE_Hysteresis(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst, uint8_t lo, uint8_t hi)
+{
+    if (!src || !dst || !src->pData || !dst->pData) return IMAGE_ERROR;
+    if (src->format != IMAGE_FORMAT_GRAYSCALE || dst->format != IMAGE_FORMAT_GRAYSCALE) return IMAGE_ERROR;
+    if (src->width != dst->width || src->height != dst->height) return IMAGE_ERROR;
+    if (src->width > IMAGE_MAX_LINE || lo > hi) return IMAGE_ERROR;
+    _occ_reset(dst);
+
+    const int w = src->width;
+    const int h = src->height;
+
+    static _HystRun rbuf[2][_BLOB_MAX_RUNS];     // ~5 KB, stack yerine statik
+    _HystRun *prev = rbuf[0], *cur = rbuf[1];
+    int np = 0;
+
+    _hy.out = dst->pData;
+    _hy.w = (uint16_t)w;
+    _hy.nmerged = 0;
+    _hy.nfree = _HYST_LABELS;
+    for (uint16_t i = 0; i < _HYST_LABELS; i++)
+        _hy.free_list[i] = (uint16_t)(_HYST_LABELS - 1 - i);
+    for (uint16_t i = 0; i < IMAGE_HYST_MAX_PENDING; i++)
+        _hy.pend[i].next = (i + 1u < IMAGE_HYST_MAX_PENDING) ? (uint16_t)(i + 1u) : (uint16_t)_HYST_NIL;
+    _hy.pfree = 0;
+    _hy.spill = 0;
+
+    for (int y = 0; y <= h; y++)
+    {
+        int nc = 0;
+        if (y < h)
+        {
+            // koşular okunduktan sonra satır temizlenir: src == dst güvenli
+            nc = _hyst_row_runs(src->pData + (uint32_t)y * w, w, lo, hi, cur);
+            memset(dst->pData + (uint32_t)y * w, 0, (size_t)w);
+        }
+
+        for (int j = 0, k0 = 0; j < nc; j++)
+        {
+            _HystRun *c = &cur[j];
+            int label = -1;
+
+            while (k0 < np && prev[k0].x1 + 1 < c->x0) k0++;
+            for (int k = k0; k < np && prev[k].x0 <= c->x1 + 1; k++)
+            {
+                if (label < 0) label = _hyst_find(prev[k].label);
+                else label = _hyst_union((uint16_t)label, prev[k].label);
+            }
+
+            if (label < 0)
+            {
+                label = _hy.free_list[--_hy.nfree];
+                _hy.parent[label] = (uint16_t)label;
+                _hy.head[label] = _hy.tail[label] = _HYST_NIL;
+                _hy.strong[label] = 0;
+                _hy.seen[label] = 0;
+            }
+            if (c->strong && !_hy.strong[label])
+            {
+                _hy.strong[label] = 1;
+                _hyst_drop((uint16_t)label, 1);
+            }
+            c->label = (uint16_t)label;
+        }
+
+        // satırın birleşmeleri bitti: güçlü koşular yazılır, kalanlar bekler
+        for (int j = 0; j < nc; j++)
+        {
+            _HystRun *c = &cur[j];
+            uint16_t r = _hyst_find(c->label);
+            c->label = r;
+            _hy.seen[r] = (uint16_t)(y + 1);
+
+            if (_hy.strong[r])
+            {
+                memset(dst->pData + (uint32_t)y * w + c->x0, 255, (size_t)(c->x1 - c->x0 + 1));
+                continue;
+            }
+            if (_hy.pfree == _HYST_NIL)
+            {
+                memset(dst->pData + (uint32_t)y * w + c->x0, _HYST_TENT, (size_t)(c->x1 - c->x0 + 1));
+                _hy.spill = 1;
+                continue;
+            }
+            uint16_t e = _hy.pfree;
+            _hy.pfree = _hy.pend[e].next;
+            _hy.pend[e].y = (uint16_t)y;
+            _hy.pend[e].x0 = c->x0;
+            _hy.pend[e].x1 = c->x1;
+            _hy.pend[e].next = _HYST_NIL;
+            if (_hy.head[r] == _HYST_NIL) _hy.head[r] = e;
+            else _hy.pend[_hy.tail[r]].next = e;
+            _hy.tail[r] = e;
+        }
+
+        // bu satırda devam etmeyen bileşenler kapanır; zayıf kalanlar atılır
+        for (int k = 0; k < np; k++)
+        {
+            uint16_t r = _hyst_find(prev[k].label);
+            if (_hy.seen[r] == (uint16_t)(y + 1)) continue;
+            _hy.seen[r] = (uint16_t)(y + 1);
+            _hyst_drop(r, 0);
+            _hy.free_list[_hy.nfree++] = r;
+        }
+
+        while (_hy.nmerged) _hy.free_list[_hy.nfree++] = _hy.merged[--_hy.nmerged];
+
+        _HystRun *t = prev; prev = cur; cur = t;
+        np = nc;
+    }
+
+    if (_hy.spill)
+    {
+        // geçici koşunun bileşeni 8-komşu bağlıdır; güçlüyse bir 255 içerir
+        _recon_flood_tagged(dst->pData, w, h, _HYST_TENT, 255, 1);
+        for (uint32_t i = 0; i < (uint32_t)w * h; i++)
+            if (dst->pData[i] == _HYST_TENT) dst->pData[i] = 0;
+    }
+
+    return IMAGE_OK;
+}
+
+// Eşikler histogramdan iki eşikli Otsu ile seçilir: lo = t0, hi = t1
+int8_t IMAGE_HysteresisOtsu(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst)
+{
+    if (!src || !src->pData || src->format != IMAGE_FORMAT_GRAYSCALE) return IMAGE_ERROR;
+
+    static uint32_t hist[256];   // 1 KB, stack yerine statik
+    uint8_t t[2];
+
+    IMAGE_Histogram(src->pData, src->width, src->height, src->width, NULL, NULL, 0, hist, 0);
+    if (IMAGE_OtsuMulti(hist, 2, t) != IMAGE_OK) return IMAGE_ERROR;
+    return IMAGE_Hysteresis(src, dst, t[0], t[1]);
+}
+
+/* ---------------------------------------------------------------------------
+ * Chamfer uzaklık dönüşümü: her 255 pikselin en yakın arka plan pikseline
+ * uzaklığı, ileri + geri iki geçişte. Çerçeve dışı arka plan sayılır, yani
+ * IMAGE_Erode3x3 ile aynı kenar kuralı. Birim: bir yatay adım
+ * IMAGE_DIST_UNIT(metric) (3 ya da 5); k yarıçaplı erozyon = dist > k*birim.
+ * ------------------------------------------------------------------------- */
+
+typedef struct { int8_t dx, dy; uint8_t w; } _DTStep;
+
+// İleri geçiş maskesi (önceki satırlar + soldaki piksel); geri geçiş bunun aynası
+static const _DTStep _dt_34[]    = { {-1, 0, 3}, {-1, -1, 4}, {0, -1, 3}, {1, -1, 4} };
+static const _DTStep _dt_5711[]  = { {-1, 0, 5}, {-1, -1, 7}, {0, -1, 5}, {1, -1, 7},
+                                     {-2, -1, 11}, {-1, -2, 11}, {1, -2, 11}, {2, -1, 11} };
+
+static inline uint16_t _dt_rd(const uint8_t *d8, const uint16_t *d16, int x, int y, int w, int h)
+{
+    if ((unsigned)x >= (unsigned)w || (unsigned)y >= (unsigned)h) return 0;
+    return d8 ? d8[y*w + x] : d16[y*w + x];
+}
+
+// d8 ya da d16'dan biri kullanılır; d8 255'te doyar (min-artı işlemleri
+// doyumla yer değiştirdiği için sonuç min(255, gerçek) olur). d8 == src olabilir.
+static void _dt_run(const uint8_t *in, uint8_t *d8, uint16_t *d16, int w, int h, IMAGE_DistMetric metric)
+{
+    const _DTStep *m = (metric == IMAGE_DIST_CHAMFER_5_7_11) ? _dt_5711 : _dt_34;
+    const int nm = (metric == IMAGE_DIST_CHAMFER_5_7_11) ? 8 : 4;
+    const uint16_t lim = d8 ? 255 : 0xFFFF;
+
+    for (int y = 0; y < h; y++)
+    {
+        for (int x = 0; x < w; x++)
+        {
+            uint16_t v = 0;
+
+            if (in[y*w + x] == 255)
+            {
+                v = lim;
+                for (int k = 0; k < nm; k++)
+                {
+                    uint16_t c = _dt_rd(d8, d16, x + m[k].dx, y + m[k].dy, w, h) + m[k].w;
+                    if (c < v) v = c;
+                }
+            }
+            if (d8) d8[y*w + x] = (uint8_t)v; else d16[y*w + x] = v;
+        }
+    }
+
+    for (int y = h - 1; y >= 0; y--)
+    {
+        for (int x = w - 1; x >= 0; x--)
+        {
+            uint16_t v = d8 ? d8[y*w + x] : d16[y*w + x];
+            if (v == 0) continue;
+
+            for (int k = 0; k < nm; k++)
+            {
+                uint16_t c = _dt_rd(d8, d16, x - m[k].dx, y - m[k].dy, w, h) + m[k].w;
+                if (c < v) v = c;
+            }
+            if (d8) d8[y*w + x] = (uint8_t)v; else d16[y*w + x] = v;
+        }
+    }
+}
+
+// dist: width*height uint16_t, chamfer biriminde
+int8_t IMAGE_DistanceTransform(const IMAGE_HandleTypeDef *src, uint16_t *dist, IMAGE_DistMetric metric)
+{
+    if (!src || !src->pData || !dist) return IMAGE_ERROR;
+    if (src->format != IMAGE_FORMAT_GRAYSCALE) return IMAGE_ERROR;
+
+    _dt_run(src->pData, NULL, dist, src->width, src->height, metric);
+    return IMAGE_OK;
+}
+
+// 8-bit, 255'te doyan uzaklık haritası; src == dst olabilir
+int8_t IMAGE_DistanceTransform8(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst, IMAGE_DistMetric metric)
+{
+    if (!src || !dst || !src->pData || !dst->pData) return IMAGE_ERROR;
+    if (src->format != IMAGE_FORMAT_GRAYSCALE || dst->format != IMAGE_FORMAT_GRAYSCALE) return IMAGE_ERROR;
+    if (src->width != dst->width || src->height != dst->height) return IMAGE_ERROR;
+    _occ_reset(dst);
+
+    _dt_run(src->pData, dst->pData, NULL, src->width, src->height, metric);
+    return IMAGE_OK;
+}
+
+/* ---------------------------------------------------------------------------
+ * 512 girişli LUT ile 3x3 ikili komşuluk motoru. Her piksel için 9-bit kod
+ * kaydırma + OR ile yuvarlanır (IMAGE_LUT3x3_BIT düzeni: sütun sütun),
+ * çıkış tek bir tablo okumasıdır, dal yoktur. Dilate, erode, hit-or-miss,
+ * uç nokta ve Zhang-Suen geçişleri yalnızca farklı tablolardır.
+ * ------------------------------------------------------------------------- */
+
+// Satırları 0/1 olarak tutan 3 satırlık geçmiş; sondaki +1 bayt x = w için 0 dolgu
+static void _lut_load_row(const uint8_t *in, uint8_t *row, int w)
+{
+    for (int x = 0; x < w; x++) row[x] = (in[x] == 255);
+    row[w] = 0;
+}
+
+/**
+  * @brief  dst = lut[code(src)] for every pixel, code built from the 3x3
+  *         neighbourhood (255 = 1, anything else or out of frame = 0).
+  * @param  changed  Optional, receives the number of pixels whose 0/255 value changed
+  * @note   src == dst is allowed.
+  */
+int8_t IMAGE_ApplyLUT3x3(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst, const uint8_t lut[512], uint32_t *changed)
+{
+    if (!src || !dst || !lut || !src->pData || !dst->pData) return IMAGE_ERROR;
+    if (src->format != IMAGE_FORMAT_GRAYSCALE || dst->format != IMAGE_FORMAT_GRAYSCALE) return IMAGE_ERROR;
+    if (src->width != dst->width || src->height != dst->height) return IMAGE_ERROR;
+    if (src->width > IMAGE_MAX_LINE) return IMAGE_ERROR;
+    _occ_reset(dst);
 
     const int w = src->width;
     const int h = src->height;
     const uint8_t *in = src->pData;
     uint8_t *out = dst->pData;
+    uint32_t nchg = 0;
+
+    static const uint8_t zero[IMAGE_MAX_LINE + 1] = {0};
+    static uint8_t ring[3][IMAGE_MAX_LINE + 1];   // ~2 KB, stack yerine statik
+
+    _lut_load_row(in, ring[0], w);
+
+    for (int y = 0; y < h; y++)
+    {
+        const uint8_t *u = (y > 0) ? ring[(y + 2) % 3] : zero;
+        const uint8_t *m = ring[y % 3];
+        const uint8_t *d = zero;
+
+        if (y + 1 < h)
+        {
+            _lut_load_row(in + (y + 1)*w, ring[(y + 1) % 3], w);
+            d = ring[(y + 1) % 3];
+        }
+
+        uint8_t *o = out + y*w;
+        uint32_t code = (uint32_t)(u[0] | (m[0] << 1) | (d[0] << 2)) << 6;
+
+        for (int x = 0; x < w; x++)
+        {
+            code = (code >> 3) | ((uint32_t)(u[x+1] | (m[x+1] << 1) | (d[x+1] << 2)) << 6);
+            uint8_t v = lut[code];
+            nchg += (v != 0) != m[x];
+            o[x] = v;
+        }
+    }
+
+    if (changed) *changed = nchg;
+    return IMAGE_OK;
+}
+
+// 255 if any of the 9 bits is set
+void IMAGE_LUT3x3_Dilate(uint8_t lut[512])
+{
+    for (int c = 0; c < 512; c++) lut[c] = c ? 255 : 0;
+}
+
+// 255 only if all 9 bits are set
+void IMAGE_LUT3x3_Erode(uint8_t lut[512])
+{
+    for (int c = 0; c < 512; c++) lut[c] = (c == 511) ? 255 : 0;
+}
+
+// 255 where every bit of hit is 1 and every bit of miss is 0
+void IMAGE_LUT3x3_HitOrMiss(uint8_t lut[512], uint16_t hit, uint16_t miss)
+{
+    for (int c = 0; c < 512; c++)
+        lut[c] = ((c & hit) == hit && (c & miss) == 0) ? 255 : 0;
+}
+
+// Merkez sırasıyla N, NE, E, SE, S, SW, W, NW komşularının bitleri
+static const uint16_t _lut_ring8[8] = {
+    IMAGE_LUT3x3_BIT( 0, -1), IMAGE_LUT3x3_BIT( 1, -1), IMAGE_LUT3x3_BIT( 1,  0), IMAGE_LUT3x3_BIT( 1,  1),
+    IMAGE_LUT3x3_BIT( 0,  1), IMAGE_LUT3x3_BIT(-1,  1), IMAGE_LUT3x3_BIT(-1,  0), IMAGE_LUT3x3_BIT(-1, -1),
+};
+
+// 255 where a foreground pixel has exactly one foreground neighbour
+void IMAGE_LUT3x3_Endpoints(uint8_t lut[512])
+{
+    for (int c = 0; c < 512; c++)
+    {
+        int n = 0;
+        for (int k = 0; k < 8; k++) n += (c & _lut_ring8[k]) != 0;
+        lut[c] = ((c & IMAGE_LUT3x3_BIT(0, 0)) && n == 1) ? 255 : 0;
+    }
+}
+
+// Zhang-Suen alt geçişi (pass 0 ya da 1): silinecek piksel 0, diğerleri aynen
+void IMAGE_LUT3x3_ZhangSuen(uint8_t lut[512], uint8_t pass)
+{
+    for (int c = 0; c < 512; c++)
+    {
+        uint8_t p[8];   // P2..P9
+        int b = 0, a = 0;
+
+        for (int k = 0; k < 8; k++) { p[k] = (c & _lut_ring8[k]) != 0; b += p[k]; }
+        for (int k = 0; k < 8; k++) a += (!p[k] && p[(k + 1) & 7]);
+
+        const uint8_t fg = (c & IMAGE_LUT3x3_BIT(0, 0)) != 0;
+        // p[0]=P2(N) p[2]=P4(E) p[4]=P6(S) p[6]=P8(W)
+        const uint8_t cond = pass ? (!(p[0] && p[2] && p[6]) && !(p[0] && p[4] && p[6]))
+                                  : (!(p[0] && p[2] && p[4]) && !(p[2] && p[4] && p[6]));
+        const uint8_t del = fg && b >= 2 && b <= 6 && a == 1 && cond;
+
+        lut[c] = (fg && !del) ? 255 : 0;
+    }
+}
+
+/* ---------------------------------------------------------------------------
+ * İskelet çıkarma: Zhang-Suen alt geçişleri (LUT motorunun tabloları),
+ * yalnızca değişen satırların ±1 komşuluğunda tekrar çalışır. Bir satırın
+ * 3x3 komşuluğu son değerlendirmeden beri değişmediyse sonucu da değişmez.
+ * ------------------------------------------------------------------------- */
+
+// lut'u seçili satırlara yerinde uygular; değişen satırları chg'ye işaretler.
+// Alt geçiş paralel olmalı: işlenmiş üst satırın eski hali ayrıca saklanır.
+static uint32_t _lut_apply_rows(uint8_t *img, int w, int h, const uint8_t lut[512],
+                                const uint8_t *active, uint8_t *chg)
+{
+    static const uint8_t zero[IMAGE_MAX_LINE + 1] = {0};
+    static uint8_t rows[4][IMAGE_MAX_LINE + 1];   // ~2.6 KB, stack yerine statik
+    uint8_t *saved = rows[0], *u = rows[1], *m = rows[2], *d = rows[3];
+    uint8_t saved_valid = 0;
+    uint32_t total = 0;
+
+    for (int y = 0; y < h; y++)
+    {
+        if (!active[y]) { chg[y] = 0; saved_valid = 0; continue; }
+
+        const uint8_t *up = zero;
+        if (y > 0)
+        {
+            if (saved_valid) up = saved;
+            else { _lut_load_row(img + (y - 1)*w, u, w); up = u; }
+        }
+        _lut_load_row(img + y*w, m, w);
+        const uint8_t *down = zero;
+        if (y + 1 < h) { _lut_load_row(img + (y + 1)*w, d, w); down = d; }
+
+        uint8_t *o = img + y*w;
+        uint32_t n = 0;
+        uint32_t code = (uint32_t)(up[0] | (m[0] << 1) | (down[0] << 2)) << 6;
+
+        for (int x = 0; x < w; x++)
+        {
+            code = (code >> 3) | ((uint32_t)(up[x+1] | (m[x+1] << 1) | (down[x+1] << 2)) << 6);
+            uint8_t v = lut[code];
+            n += (v != 0) != m[x];
+            o[x] = v;
+        }
+
+        chg[y] = (n != 0);
+        total += n;
+
+        // m (satır y'nin eski hali) bir sonraki satırın "up"ı olur
+        uint8_t *t = saved; saved = m; m = t;
+        saved_valid = 1;
+    }
+    return total;
+}
+
+/**
+  * @brief  Zhang-Suen thinning of the 255-foreground of src into dst.
+  * @param  max_iter  Maximum number of full (two sub-pass) iterations, 0 = until stable
+  * @note   src == dst is allowed. Pixels other than 255 are treated as background.
+  */
+int8_t IMAGE_Skeletonize(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst, uint16_t max_iter)
+{
+    if (!src || !dst || !src->pData || !dst->pData) return IMAGE_ERROR;
+    if (src->format != IMAGE_FORMAT_GRAYSCALE || dst->format != IMAGE_FORMAT_GRAYSCALE) return IMAGE_ERROR;
+    if (src->width != dst->width || src->height != dst->height) return IMAGE_ERROR;
+    if (src->width > IMAGE_MAX_LINE || src->height > IMAGE_MAX_LINE) return IMAGE_ERROR;
+    _occ_reset(dst);
+
+    const int w = src->width;
+    const int h = src->height;
+    uint8_t *img = dst->pData;
+
+    for (uint32_t i = 0; i < (uint32_t)w * h; i++)
+        img[i] = (src->pData[i] == 255) ? 255 : 0;
+
+    // ~2.9 KB, 1 KB'lık stack yerine statik
+    static uint8_t lut[2][512];
+    static uint8_t chg[2][IMAGE_MAX_LINE];
+    static uint8_t active[IMAGE_MAX_LINE];
+
+    IMAGE_LUT3x3_ZhangSuen(lut[0], 0);
+    IMAGE_LUT3x3_ZhangSuen(lut[1], 1);
+    memset(chg, 1, sizeof(chg));
+
+    for (uint32_t it = 0; max_iter == 0 || it < max_iter; it++)
+    {
+        uint32_t n = 0;
+
+        for (int p = 0; p < 2; p++)
+        {
+            // bu alt geçişin son çalışmasından beri değişen satırlar ve komşuları
+            for (int y = 0; y < h; y++)
+            {
+                uint8_t a = chg[0][y] | chg[1][y];
+                if (y > 0)     a |= chg[0][y-1] | chg[1][y-1];
+                if (y + 1 < h) a |= chg[0][y+1] | chg[1][y+1];
+                active[y] = a;
+            }
+            n += _lut_apply_rows(img, w, h, lut[p], active, chg[p]);
+        }
+
+        if (n == 0) break;
+    }
+
+    return IMAGE_OK;
+}
+
+/* ---------------------------------------------------------------------------
+ * Yakınsamaya kadar tekrarlanan 3x3 morfoloji. Her geçişte değişen satırlar
+ * işaretlenir; sonraki geçiş yalnızca değişen bir satırın halo'su içindeki
+ * satırları (dilate/erode için ±1, opening/closing için ±2) yeniden hesaplar.
+ * Halo'sunda hiçbir satır değişmemiş bir satırın sonucu da değişmez.
+ * ------------------------------------------------------------------------- */
+
+// Çıkış satırları y0..y1, img üzerinde yerinde. Okunan satırlar y0-passes ..
+// y1+passes; çıkış satırı y, y+passes okunduktan sonra yazılır. Değişen
+// satırlar chg'ye işaretlenir, değişen satır sayısı döner.
+static uint32_t _iter_segment(uint8_t *img, int w, int h, int y0, int y1,
+                              uint8_t first_erode, uint8_t passes, uint8_t *chg)
+{
+    const uint8_t e1 = first_erode;
+    const uint8_t e2 = !first_erode;
+    const int r0 = (y0 > 0) ? y0 - 1 : 0;
+    const int r1 = (y1 + 1 < h) ? y1 + 1 : h - 1;
+    uint32_t n = 0;
+
+    // ~4.5 KB, 1 KB'lık stack yerine statik
+    static uint8_t h1[3][IMAGE_MAX_LINE];
+    static uint8_t h2[3][IMAGE_MAX_LINE];
+    static uint8_t mid[IMAGE_MAX_LINE];
+
+    for (int t = (y0 > passes) ? y0 - passes : 0; t <= y1 + passes; t++)
+    {
+        if (t < h)
+            _row_h3(img + t*w, h1[t % 3], w, e1, 1);
+
+        int y = t - 1;
+        if (passes == 1)
+        {
+            if (y < y0 || y >= h) continue;
+            _row_v3((y > 0) ? h1[(y - 1) % 3] : NULL, h1[y % 3], (y + 1 < h) ? h1[(y + 1) % 3] : NULL, mid, w, e1);
+        }
+        else
+        {
+            const int r = t - 1;
+            if (r >= r0 && r <= r1)
+            {
+                _row_v3((r > 0) ? h1[(r - 1) % 3] : NULL, h1[r % 3], (r + 1 < h) ? h1[(r + 1) % 3] : NULL, mid, w, e1);
+                _row_h3(mid, h2[r % 3], w, e2, 0);
+            }
+
+            y = t - 2;
+            if (y < y0 || y >= h) continue;
+            _row_v3((y > 0) ? h2[(y - 1) % 3] : NULL, h2[y % 3], (y + 1 < h) ? h2[(y + 1) % 3] : NULL, mid, w, e2);
+        }
+
+        uint8_t *o = img + y*w;
+        chg[y] = (memcmp(o, mid, (size_t)w) != 0);
+        if (chg[y]) { memcpy(o, mid, (size_t)w); n++; }
+    }
+    return n;
+}
+
+/**
+  * @brief  Apply a 3x3 dilate/erode/opening/closing to src repeatedly until the
+  *         result stops changing, writing into dst.
+  * @param  max_iter  Maximum number of applications, 0 = until stable
+  * @note   src == dst is allowed. Pixels other than 255 are treated as background.
+  */
+int8_t IMAGE_MorphIterate(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst, IMAGE_MorphOp op, uint16_t max_iter)
+{
+    if (!src || !dst || !src->pData || !dst->pData) return IMAGE_ERROR;
+    if (src->format != IMAGE_FORMAT_GRAYSCALE || dst->format != IMAGE_FORMAT_GRAYSCALE) return IMAGE_ERROR;
+    if (src->width != dst->width || src->height != dst->height) return IMAGE_ERROR;
+    if (src->width > IMAGE_MAX_LINE || src->height > IMAGE_MAX_LINE) return IMAGE_ERROR;
+    if (op > IMAGE_MORPH_CLOSE) return IMAGE_ERROR;
+    _occ_reset(dst);
+
+    const int w = src->width;
+    const int h = src->height;
+    uint8_t *img = dst->pData;
+    const uint8_t first_erode = (op == IMAGE_MORPH_ERODE || op == IMAGE_MORPH_OPEN);
+    const uint8_t passes = (op == IMAGE_MORPH_OPEN || op == IMAGE_MORPH_CLOSE) ? 2 : 1;
+
+    static uint8_t chg[IMAGE_MAX_LINE];
+    static uint8_t active[IMAGE_MAX_LINE];
+
+    if (src->pData != img) memcpy(img, src->pData, (size_t)w * h);
+    memset(chg, 1, sizeof(chg));
+
+    for (uint32_t it = 0; max_iter == 0 || it < max_iter; it++)
+    {
+        // değişen satırların halo'su
+        for (int y = 0; y < h; y++)
+        {
+            uint8_t a = 0;
+            for (int d = -passes; d <= passes && !a; d++)
+                if (y + d >= 0 && y + d < h) a = chg[y + d];
+            active[y] = a;
+        }
+
+        // Aktif satırları parçalara böl; aradaki boşluk halo'dan kısaysa
+        // birleştir ki bir parçanın okuduğu satırlar önceki parçada yazılmamış olsun.
+        uint32_t n = 0;
+        int y = 0;
+        while (y < h)
+        {
+            if (!active[y]) { chg[y++] = 0; continue; }
+
+            int y1 = y;
+            for (int k = y + 1; k < h && k - y1 <= passes; k++)
+                if (active[k]) y1 = k;
+
+            n += _iter_segment(img, w, h, y, y1, first_erode, passes, chg);
+            y = y1 + 1;
+        }
+
+        if (n == 0) break;
+    }
+
+    return IMAGE_OK;
+}
+
+// 255 piksellerin (x, y) listesi, satır sırasıyla. count toplam sayıdır,
+// max_pts'den fazlası yazılmaz.
+int8_t IMAGE_ListPixels(const IMAGE_HandleTypeDef *img, IMAGE_PointTypeDef *pts, uint32_t max_pts, uint32_t *count)
+{
+    if (!img || !img->pData || !count || (!pts && max_pts)) return IMAGE_ERROR;
+    if (img->format != IMAGE_FORMAT_GRAYSCALE) return IMAGE_ERROR;
+
+    uint32_t n = 0;
+    const uint8_t *p = img->pData;
+
+    for (uint16_t y = 0; y < img->height; y++)
+    {
+        for (uint16_t x = 0; x < img->width; x++, p++)
+        {
+            if (*p != 255) continue;
+            if (n < max_pts) { pts[n].x = x; pts[n].y = y; }
+            n++;
+        }
+    }
+
+    *count = n;
+    return IMAGE_OK;
+}
+
+/* ---------------------------------------------------------------------------
+ * Morfolojik yeniden yapılandırma (Vincent'in hibrit algoritması): bir
+ * ileri + bir geri tarama, ardından ilerlemeye devam edebilecek sınır
+ * pikselleri FIFO ile yayılır; her piksel sabit sayıda ziyaret edilir.
+ * Kuyruk sabit boyutludur; dolarsa atılan pikseller için geri tarama tekrar
+ * edilir (sonuç aynı kalır, yalnızca birkaç ek tarama yapılır).
+ * ------------------------------------------------------------------------- */
+
+#define _RECON_QLEN			2048u
+
+typedef struct
+{
+    uint32_t buf[_RECON_QLEN];
+    uint32_t head;
+    uint32_t n;
+    uint8_t  overflow;
+}_ReconQueue;
+
+static _ReconQueue _rq;
+
+static inline void _rq_push(uint32_t i)
+{
+    if (_rq.n == _RECON_QLEN) { _rq.overflow = 1; return; }
+    _rq.buf[(_rq.head + _rq.n) % _RECON_QLEN] = i;
+    _rq.n++;
+}
+
+static inline uint32_t _rq_pop(void)
+{
+    uint32_t i = _rq.buf[_rq.head];
+    _rq.head = (_rq.head + 1) % _RECON_QLEN;
+    _rq.n--;
+    return i;
+}
+
+// Tarama sırasına göre önceki (N+) yarı komşuluk: W, NW, N, NE
+static const int8_t _rc_dx[4] = { -1, -1, 0, 1 };
+static const int8_t _rc_dy[4] = {  0, -1, -1, -1 };
+
+// Geri tarama; N- komşularından biri hâlâ yükselebiliyorsa p kuyruğa girer
+static void _recon_backward(uint8_t *J, const uint8_t *I, int w, int h, uint8_t inv)
+{
+    for (int y = h - 1; y >= 0; y--)
+    {
+        for (int x = w - 1; x >= 0; x--)
+        {
+            const uint32_t p = (uint32_t)y*w + x;
+            uint8_t v = J[p];
+
+            for (int k = 0; k < 4; k++)
+            {
+                int qx = x - _rc_dx[k], qy = y - _rc_dy[k];
+                if ((unsigned)qx >= (unsigned)w || (unsigned)qy >= (unsigned)h) continue;
+                if (J[qy*w + qx] > v) v = J[qy*w + qx];
+            }
+            const uint8_t m = I[p] ^ inv;
+            J[p] = v = (v < m) ? v : m;
+
+            for (int k = 0; k < 4; k++)
+            {
+                int qx = x - _rc_dx[k], qy = y - _rc_dy[k];
+                if ((unsigned)qx >= (unsigned)w || (unsigned)qy >= (unsigned)h) continue;
+                const uint32_t q = (uint32_t)qy*w + qx;
+                if (J[q] < v && J[q] < (I[q] ^ inv)) { _rq_push(p); break; }
+            }
+        }
+    }
+}
+
+// J = R_I(J) (dilation ile, 8-komşu). inv = 0xFF ise J ve I tümlenmiş
+// kabul edilir, bu da erozyon ile yeniden yapılandırmayı verir.
+static void _recon_gray(uint8_t *J, const uint8_t *I, int w, int h, uint8_t inv)
+{
+    const uint32_t total = (uint32_t)w * h;
+
+    if (inv) for (uint32_t i = 0; i < total; i++) J[i] ^= 0xFF;
+
+    for (int y = 0; y < h; y++)
+    {
+        for (int x = 0; x < w; x++)
+        {
+            const uint32_t p = (uint32_t)y*w + x;
+            uint8_t v = J[p];
+
+            for (int k = 0; k < 4; k++)
+            {
+                int qx = x + _rc_dx[k], qy = y + _rc_dy[k];
+                if ((unsigned)qx >= (unsigned)w || (unsigned)qy >= (unsigned)h) continue;
+                if (J[qy*w + qx] > v) v = J[qy*w + qx];
+            }
+            const uint8_t m = I[p] ^ inv;
+            J[p] = (v < m) ? v : m;
+        }
+    }
+
+    _rq.head = 0; _rq.n = 0;
+    do
+    {
+        _rq.overflow = 0;
+        _recon_backward(J, I, w, h, inv);
+
+        while (_rq.n)
+        {
+            const uint32_t p = _rq_pop();
+            const int px = (int)(p % (uint32_t)w), py = (int)(p / (uint32_t)w);
+            const uint8_t v = J[p];
+
+            for (int dy = -1; dy <= 1; dy++)
+            {
+                for (int dx = -1; dx <= 1; dx++)
+                {
+                    int qx = px + dx, qy = py + dy;
+                    if ((dx | dy) == 0 || (unsigned)qx >= (unsigned)w || (unsigned)qy >= (unsigned)h) continue;
+
+                    const uint32_t q = (uint32_t)qy*w + qx;
+                    const uint8_t m = I[q] ^ inv;
+                    if (J[q] < v && J[q] != m)
+                    {
+                        J[q] = (v < m) ? v : m;
+                        _rq_push(q);
+                    }
+                }
+            }
+        }
+    } while (_rq.overflow);
+
+    if (inv) for (uint32_t i = 0; i < total; i++) J[i] ^= 0xFF;
+}
 
+static int8_t _recon_check(const IMAGE_HandleTypeDef *mask, const IMAGE_HandleTypeDef *marker)
+{
+    if (!mask || !marker || !mask->pData || !marker->pData) return IMAGE_ERROR;
+    if (mask->format != IMAGE_FORMAT_GRAYSCALE || marker->format != IMAGE_FORMAT_GRAYSCALE) return IMAGE_ERROR;
+    if (mask->width != marker->width || mask->height != marker->height) return IMAGE_ERROR;
+    if (mask->pData == marker->pData) return IMAGE_ERROR;
+    return IMAGE_OK;
+}
+
+/**
+  * @brief  Grayscale reconstruction by dilation: marker is grown under mask
+  *         (8-connected) until stable; result replaces marker.
+  * @note   marker > mask is clipped to mask. marker and mask must not share a buffer.
+  */
+int8_t IMAGE_ReconstructDilate(const IMAGE_HandleTypeDef *mask, IMAGE_HandleTypeDef *marker)
+{
+    if (_recon_check(mask, marker) != IMAGE_OK) return IMAGE_ERROR;
+    _occ_reset(marker);
+
+    _recon_gray(marker->pData, mask->pData, marker->width, marker->height, 0);
+    return IMAGE_OK;
+}
+
+// Erozyon ile yeniden yapılandırma (marker >= mask), dilation'ın düalidir
+int8_t IMAGE_ReconstructErode(const IMAGE_HandleTypeDef *mask, IMAGE_HandleTypeDef *marker)
+{
+    if (_recon_check(mask, marker) != IMAGE_OK) return IMAGE_ERROR;
+    _occ_reset(marker);
+
+    _recon_gray(marker->pData, mask->pData, marker->width, marker->height, 0xFF);
+    return IMAGE_OK;
+}
+
+// 'from' komşusu olan her 'tag' pikseli kuyruğa (taşma sonrası yeniden tohum)
+static void _recon_flood_seed(uint8_t *img, int w, int h, uint8_t from, uint8_t tag, uint8_t conn8)
+{
     for (int y = 0; y < h; y++)
     {
         for (int x = 0; x < w; x++)
         {
-            uint8_t any = 0;
+            const uint32_t p = (uint32_t)y*w + x;
+            if (img[p] != tag) continue;
 
-            for (int j = -1; j <= 1 && !any; j++)
+            uint8_t grow = 0;
+            for (int dy = -1; dy <= 1 && !grow; dy++)
             {
-                for (int i = -1; i <= 1; i++)
+                for (int dx = -1; dx <= 1; dx++)
                 {
-                    if (_px_get0(in, x+i, y+j, w, h) == 255) { any = 1; break; }
+                    if ((dx | dy) == 0 || (!conn8 && dx && dy)) continue;
+                    int qx = x + dx, qy = y + dy;
+                    if ((unsigned)qx >= (unsigned)w || (unsigned)qy >= (unsigned)h) continue;
+                    if (img[qy*w + qx] == from) { grow = 1; break; }
                 }
             }
-            out[y*w + x] = any ? 255 : 0;
+            if (grow) _rq_push(p);
         }
     }
 }
 
-// dst = erode(src)   (3x3)
-// Sınır dışı 0 sayıldığı için kenarlar daha kolay erozyona uğrar .
-void IMAGE_Erode3x3(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst)
+// Kuyruktaki 'tag' piksellerinden 'from' piksellerine yayılır; kuyruğa
+// sığmayan pikseller için tohum taraması tekrarlanır.
+static void _recon_flood_run(uint8_t *img, int w, int h, uint8_t from, uint8_t tag, uint8_t conn8)
 {
-    if (!src || !dst || !src->pData || !dst->pData) return;
-    if (src->format != IMAGE_FORMAT_GRAYSCALE || dst->format != IMAGE_FORMAT_GRAYSCALE) return;
-    if (src->width != dst->width || src->height != dst->height) return;
+    for (;;)
+    {
+        while (_rq.n)
+        {
+            const uint32_t p = _rq_pop();
+            const int px = (int)(p % (uint32_t)w), py = (int)(p / (uint32_t)w);
 
-    const int w = src->width;
-    const int h = src->height;
-    const uint8_t *in = src->pData;
-    uint8_t *out = dst->pData;
+            for (int dy = -1; dy <= 1; dy++)
+            {
+                for (int dx = -1; dx <= 1; dx++)
+                {
+                    if ((dx | dy) == 0 || (!conn8 && dx && dy)) continue;
+                    int qx = px + dx, qy = py + dy;
+                    if ((unsigned)qx >= (unsigned)w || (unsigned)qy >= (unsigned)h) continue;
+
+                    const uint32_t q = (uint32_t)qy*w + qx;
+                    if (img[q] == from) { img[q] = tag; _rq_push(q); }
+                }
+            }
+        }
+        if (!_rq.overflow) break;
+
+        _rq.overflow = 0;
+        _recon_flood_seed(img, w, h, from, tag, conn8);
+    }
+}
+
+// İkili yol: değeri 'from' olan ve bir 'tag' pikseline bağlı pikseller 'tag' olur
+static void _recon_flood_tagged(uint8_t *img, int w, int h, uint8_t from, uint8_t tag, uint8_t conn8)
+{
+    _rq.head = 0; _rq.n = 0; _rq.overflow = 0;
+    _recon_flood_seed(img, w, h, from, tag, conn8);
+    _recon_flood_run(img, w, h, from, tag, conn8);
+}
+
+// İkili yol: değeri 'from' olan ve çerçeve kenarına bağlı pikseller 'tag'
+// olur. Tek buffer üzerinde çalışır, böylece src == dst mümkündür.
+static void _recon_flood_border(uint8_t *img, int w, int h, uint8_t from, uint8_t tag, uint8_t conn8)
+{
+    _rq.head = 0; _rq.n = 0; _rq.overflow = 0;
 
     for (int y = 0; y < h; y++)
     {
-        for (int x = 0; x < w; x++)
+        const int step = (y == 0 || y == h - 1) ? 1 : w - 1;
+        for (int x = 0; x < w; x += step)
+        {
+            const uint32_t p = (uint32_t)y*w + x;
+            if (img[p] == from) { img[p] = tag; _rq_push(p); }
+            if (step == 0) break;
+        }
+    }
+
+    _recon_flood_run(img, w, h, from, tag, conn8);
+}
+
+static int8_t _recon_binary_prep(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst)
+{
+    if (!src || !dst || !src->pData || !dst->pData) return IMAGE_ERROR;
+    if (src->format != IMAGE_FORMAT_GRAYSCALE || dst->format != IMAGE_FORMAT_GRAYSCALE) return IMAGE_ERROR;
+    if (src->width != dst->width || src->height != dst->height) return IMAGE_ERROR;
+    _occ_reset(dst);
+
+    const uint32_t total = (uint32_t)src->width * src->height;
+    for (uint32_t i = 0; i < total; i++)
+        dst->pData[i] = (src->pData[i] == 255) ? 255 : 0;
+    return IMAGE_OK;
+}
+
+/**
+  * @brief  Fill the holes of the 255-foreground: background not 4-connected
+  *         to the frame border becomes 255.
+  * @note   src == dst is allowed. Pixels other than 255 are treated as background.
+  */
+int8_t IMAGE_FillHoles(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst)
+{
+    if (_recon_binary_prep(src, dst) != IMAGE_OK) return IMAGE_ERROR;
+
+    const uint32_t total = (uint32_t)dst->width * dst->height;
+    uint8_t *img = dst->pData;
+
+    _recon_flood_border(img, dst->width, dst->height, 0, 1, 0);
+    for (uint32_t i = 0; i < total; i++) img[i] = (img[i] == 1) ? 0 : 255;
+    return IMAGE_OK;
+}
+
+/**
+  * @brief  Remove 255-blobs (8-connected) that touch the frame border.
+  * @note   src == dst is allowed. Pixels other than 255 are treated as background.
+  */
+int8_t IMAGE_ClearBorder(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst)
+{
+    if (_recon_binary_prep(src, dst) != IMAGE_OK) return IMAGE_ERROR;
+
+    const uint32_t total = (uint32_t)dst->width * dst->height;
+    uint8_t *img = dst->pData;
+
+    _recon_flood_border(img, dst->width, dst->height, 255, 1, 1);
+    for (uint32_t i = 0; i < total; i++) if (img[i] == 1) img[i] = 0;
+    return IMAGE_OK;
+}
+
+/* ---------------------------------------------------------------------------
+ * Histogram motoru: pikseller 32-bit okumalarla dörder dörder alınır ve her
+ * bayt ayrı bir alt histograma sayılır. Aynı değerli ardışık piksellerde tek
+ * tablo, art arda aynı sayacı okuyup yazdığı için beklerdi; dört banka ile
+ * birbirine bağımlı store'lar ayrışır. Bankalar sonda toplanır. hist ilk
+ * banka olarak kullanılır, diğer üçü statiktir (3 KB, stack'e binmez).
+ * ------------------------------------------------------------------------- */
+
+static uint32_t _hist_bank[3][256];
+
+/**
+  * @brief  256-bin histogram of a width x height window of 8-bit pixels.
+  * @param  pix     first pixel of the window; rows are stride bytes apart, so an
+  *                 ROI is pData + y0 * img_width + x0 with stride = img_width
+  * @param  lut     optional remap applied before counting (NULL = identity)
+  * @param  remap   optional output for the remapped pixels (NULL = none),
+  *                 rows remap_stride bytes apart; may equal pix
+  * @param  accumulate 0 clears hist first, otherwise counts are added to it
+  */
+int8_t IMAGE_Histogram(const uint8_t *pix, uint16_t width, uint16_t height, uint32_t stride,
+                       const uint8_t *lut, uint8_t *remap, uint32_t remap_stride,
+                       uint32_t hist[256], uint8_t accumulate)
+{
+    if (!pix || !hist || stride < width) return IMAGE_ERROR;
+    if (remap && remap_stride < width) return IMAGE_ERROR;
+
+    if (!accumulate) memset(hist, 0, 256u * sizeof(uint32_t));
+    if (width == 0 || height == 0) return IMAGE_OK;
+    memset(_hist_bank, 0, sizeof(_hist_bank));
+
+    uint32_t *b0 = hist, *b1 = _hist_bank[0], *b2 = _hist_bank[1], *b3 = _hist_bank[2];
+
+    for (uint16_t y = 0; y < height; y++)
+    {
+        const uint8_t *p = pix + (uint32_t)y * stride;
+        uint8_t *o = remap ? remap + (uint32_t)y * remap_stride : NULL;
+        uint16_t x = 0;
+
+        if (!lut)
         {
-            uint8_t all = 1;
-            // 3x3'te hepsi 255 ise -> 255, yoksa 0
-            for (int j = -1; j <= 1 && all; j++)
+            for (; x + 4 <= width; x += 4)
             {
-                for (int i = -1; i <= 1; i++)
-                {
-                    if (_px_get0(in, x+i, y+j, w, h) != 255) { all = 0; break; }
-                }
+                uint32_t v;
+                memcpy(&v, p + x, 4);
+                b0[v & 0xFF]++;
+                b1[(v >> 8) & 0xFF]++;
+                b2[(v >> 16) & 0xFF]++;
+                b3[v >> 24]++;
+            }
+            if (o && o != p) memcpy(o, p, x);
+            for (; x < width; x++)
+            {
+                b0[p[x]]++;
+                if (o) o[x] = p[x];
+            }
+            continue;
+        }
+
+        for (; x + 4 <= width; x += 4)
+        {
+            uint32_t v;
+            memcpy(&v, p + x, 4);
+            const uint8_t l0 = lut[v & 0xFF];
+            const uint8_t l1 = lut[(v >> 8) & 0xFF];
+            const uint8_t l2 = lut[(v >> 16) & 0xFF];
+            const uint8_t l3 = lut[v >> 24];
+            b0[l0]++;
+            b1[l1]++;
+            b2[l2]++;
+            b3[l3]++;
+            if (o)
+            {
+                v = (uint32_t)l0 | ((uint32_t)l1 << 8) | ((uint32_t)l2 << 16) | ((uint32_t)l3 << 24);
+                memcpy(o + x, &v, 4);
             }
-            out[y*w + x] = all ? 255 : 0;
+        }
+        for (; x < width; x++)
+        {
+            const uint8_t l = lut[p[x]];
+            b0[l]++;
+            if (o) o[x] = l;
         }
     }
+
+    for (int i = 0; i < 256; i++)
+        hist[i] += b1[i] + b2[i] + b3[i];
+    return IMAGE_OK;
 }
 
-// opening = erosion -> dilation
-void IMAGE_Opening3x3(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst, uint8_t *scratch)
+/* ---------------------------------------------------------------------------
+ * Tamsayı Otsu. Kümülatif sayım w(t) ve moment m(t) ile, N = toplam ve
+ * M = toplam moment için sınıflar arası varyans
+ *     N^2 * var(t) = (N*m - M*w)^2 / (w * (N - w))
+ * olur. Kesirler 128-bit çarpımla tam karşılaştırılır; float yok, cihaz ve
+ * host aynı eşiği bulur. N, VGA çerçevesine (640x480) kadar taşmaz.
+ * ------------------------------------------------------------------------- */
+
+typedef struct { uint64_t hi, lo; } _U128;
+
+static _U128 _mul64(uint64_t a, uint64_t b)
 {
-    if (!src || !dst || !scratch) return;
-    IMAGE_HandleTypeDef tmp = *dst;
-    tmp.pData = scratch;
+    const uint64_t a0 = (uint32_t)a, a1 = a >> 32;
+    const uint64_t b0 = (uint32_t)b, b1 = b >> 32;
+    const uint64_t p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+    const uint64_t mid = (p00 >> 32) + (uint32_t)p01 + (uint32_t)p10;
+    _U128 r;
 
-    IMAGE_Erode3x3(src, &tmp);
-    IMAGE_Dilate3x3(&tmp, dst);
+    r.lo = (mid << 32) | (uint32_t)p00;
+    r.hi = p11 + (p01 >> 32) + (p10 >> 32) + (mid >> 32);
+    return r;
 }
 
-// closing = dilation -> erosion
-void IMAGE_Closing3x3(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst, uint8_t *scratch)
+// d^2 * den, sonuç 2^128'e sığmalı
+static _U128 _sq_mul(uint64_t d, uint64_t den)
 {
-    if (!src || !dst || !scratch) return;
-    IMAGE_HandleTypeDef tmp = *dst;
-    tmp.pData = scratch;
+    _U128 sq = _mul64(d, d);
+    _U128 r = _mul64(sq.lo, den);
+    r.hi += sq.hi * den;
+    return r;
+}
 
-    IMAGE_Dilate3x3(src, &tmp);
-    IMAGE_Erode3x3(&tmp, dst);
+static inline uint8_t _u128_gt(_U128 a, _U128 b)
+{
+    return (a.hi != b.hi) ? (a.hi > b.hi) : (a.lo > b.lo);
 }
 
 static uint8_t Otsu_FromHist256(const uint32_t hist[256], uint32_t total)
 {
-    float sum = 0.0f;
+    uint64_t sum = 0;
     for (int i = 0; i < 256; i++)
-        sum += (float)i * (float)hist[i];
+        sum += (uint64_t)i * hist[i];
 
-    float sumB = 0.0f;
-    uint32_t wB = 0;
-    float varMax = 0.0f;
+    const uint64_t N = total;
+    uint64_t wB = 0, sumB = 0;
+    uint64_t best_d = 0, best_den = 1;
     uint8_t threshold = 0;
 
     for (int t = 0; t < 256; t++)
     {
         wB += hist[t];
         if (wB == 0) continue;
+        if (wB >= N) break;
 
-        uint32_t wF = total - wB;
-        if (wF == 0) break;
-
-        sumB += (float)t * (float)hist[t];
-
-        float mB = sumB / (float)wB;
-        float mF = (sum - sumB) / (float)wF;
+        sumB += (uint64_t)t * hist[t];
 
-        float diff = mB - mF;
-        float varBetween = (float)wB * (float)wF * diff * diff;
+        const uint64_t a = N * sumB, b = sum * wB;
+        const uint64_t d = (a > b) ? a - b : b - a;
+        const uint64_t den = wB * (N - wB);
 
-        if (varBetween > varMax)
+        // d^2 / den > best_d^2 / best_den
+        if (_u128_gt(_sq_mul(d, best_den), _sq_mul(best_d, den)))
         {
-            varMax = varBetween;
+            best_d = d;
+            best_den = den;
             threshold = (uint8_t)t;
         }
     }
@@ -145,6 +3254,399 @@ static uint8_t Otsu_FromHist256(const uint32_t hist[256], uint32_t total)
     return threshold;
 }
 
+/**
+  * @brief  Multi-level Otsu: nthresh thresholds (1..4) that maximise the
+  *         between-class variance of nthresh + 1 classes.
+  * @param  thresh  Receives the thresholds in ascending order; class k is
+  *                 (thresh[k-1], thresh[k]], same "pixel > t" rule as Otsu.
+  * @note   Dynamic programming over the cumulative count/moment tables, so
+  *         every candidate class costs O(1). The objective sum(S^2 / W) is
+  *         kept in 8-bit fixed point with integer division only.
+  */
+int8_t IMAGE_OtsuMulti(const uint32_t hist[256], uint8_t nthresh, uint8_t *thresh)
+{
+    if (!hist || !thresh || nthresh == 0 || nthresh > IMAGE_OTSU_MAX_LEVELS) return IMAGE_ERROR;
+
+    static uint32_t W[256];                         // kümülatif sayım
+    static uint64_t S[256];                         // kümülatif moment
+    static uint64_t F[IMAGE_OTSU_MAX_LEVELS + 1][256];
+    static uint8_t  arg[IMAGE_OTSU_MAX_LEVELS + 1][256];
+
+    uint64_t w = 0, s = 0;
+    for (int i = 0; i < 256; i++)
+    {
+        w += hist[i];
+        s += (uint64_t)i * hist[i];
+        W[i] = (uint32_t)w;
+        S[i] = s;
+    }
+    if (w == 0 || w > (uint32_t)IMAGE_RESOLUTION_VGA_WIDTH * IMAGE_RESOLUTION_VGA_HEIGHT) return IMAGE_ERROR;
+
+    // F[k][b]: 0..b aralığının k+1 sınıfa en iyi bölünmesi
+    for (int b = 0; b < 256; b++)
+        F[0][b] = W[b] ? (S[b] * S[b] << 8) / W[b] : 0;
+
+    for (int k = 1; k <= nthresh; k++)
+    {
+        const int b0 = (k == nthresh) ? 255 : k;
+        for (int b = b0; b < 256; b++)
+        {
+            uint64_t best = 0;
+            uint8_t best_a = (uint8_t)(k - 1);
+
+            // a: önceki sınıfın son kutusu, yeni sınıf (a, b]
+            for (int a = k - 1; a < b; a++)
+            {
+                const uint32_t cw = W[b] - W[a];
+                const uint64_t cs = S[b] - S[a];
+                const uint64_t v = F[k-1][a] + (cw ? (cs * cs << 8) / cw : 0);
+                if (v > best) { best = v; best_a = (uint8_t)a; }
+            }
+            F[k][b] = best;
+            arg[k][b] = best_a;
+        }
+    }
+
+    for (int k = nthresh, b = 255; k >= 1; k--)
+    {
+        b = arg[k][b];
+        thresh[k - 1] = (uint8_t)b;
+    }
+    return IMAGE_OK;
+}
+
+/**
+  * @brief  Map a GRAYSCALE image to nthresh + 1 evenly spaced levels
+  *         (0 .. 255) using ascending thresholds from IMAGE_OtsuMulti.
+  */
+int8_t IMAGE_ApplyMultiThreshold(IMAGE_HandleTypeDef *img, const uint8_t *thresh, uint8_t nthresh)
+{
+    if (!img || !img->pData || !thresh || nthresh == 0 || nthresh > IMAGE_OTSU_MAX_LEVELS) return IMAGE_ERROR;
+    if (img->format != IMAGE_FORMAT_GRAYSCALE) return IMAGE_ERROR;
+    _occ_reset(img);
+
+    uint8_t lut[256];
+    for (int v = 0, k = 0; v < 256; v++)
+    {
+        while (k < nthresh && v > thresh[k]) k++;
+        lut[v] = (uint8_t)((255u * (uint32_t)k) / nthresh);
+    }
+
+    const uint32_t total = (uint32_t)img->width * img->height;
+    for (uint32_t i = 0; i < total; i++)
+        img->pData[i] = lut[img->pData[i]];
+    return IMAGE_OK;
+}
+
+/* ---------------------------------------------------------------------------
+ * Yerel (adaptif) eşikleme: her pikselin eşiği çevresindeki kw x kh pencerenin
+ * ortalamasından (Bradley) ya da ortalama + standart sapmasından (Sauvola)
+ * gelir. Tam bir 32-bit integral görüntü yerine sütun toplamları (ve kare
+ * toplamları) satır satır kaydırılır: pencereye giren satır eklenir, çıkan
+ * satır çıkarılır. Yatayda da aynı kayan toplam kullanılır, böylece piksel
+ * başına O(1) iş ve frame yüksekliğinden bağımsız 2 x IMAGE_MAX_LINE 32-bit
+ * akümülatör yeterli olur. Çerçeve dışı pikseller pencereye katılmaz.
+ * ------------------------------------------------------------------------- */
+
+static uint32_t _ad_col[IMAGE_MAX_LINE];     // sütun toplamı, pencere satırları
+static uint32_t _ad_colsq[IMAGE_MAX_LINE];   // sütun kare toplamı (65025 * 65535 < 2^32)
+
+static inline void _ad_add_row(const uint8_t *row, int w, int sub)
+{
+    if (sub)
+    {
+        for (int x = 0; x < w; x++)
+        {
+            _ad_col[x]   -= row[x];
+            _ad_colsq[x] -= (uint32_t)row[x] * row[x];
+        }
+    }
+    else
+    {
+        for (int x = 0; x < w; x++)
+        {
+            _ad_col[x]   += row[x];
+            _ad_colsq[x] += (uint32_t)row[x] * row[x];
+        }
+    }
+}
+
+// p1/p2: Bradley için (t%, -), Sauvola için (k%, R)
+static int8_t _adaptive_thresh(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst,
+                               uint16_t kw, uint16_t kh, uint8_t sauvola, uint8_t p1, uint8_t p2)
+{
+    if (!src || !dst || !src->pData || !dst->pData) return IMAGE_ERROR;
+    if (src->format != IMAGE_FORMAT_GRAYSCALE || dst->format != IMAGE_FORMAT_GRAYSCALE) return IMAGE_ERROR;
+    if (src->width != dst->width || src->height != dst->height) return IMAGE_ERROR;
+    if (src->width > IMAGE_MAX_LINE || kw == 0 || kh == 0) return IMAGE_ERROR;
+    // çıkan satır hâlâ okunduğu için yerinde çalışamaz
+    if (src->pData == dst->pData) return IMAGE_ERROR;
+    _occ_reset(dst);
+
+    const int w = src->width;
+    const int h = src->height;
+    const int rx = kw / 2, sx = kw - 1 - rx;
+    const int ry = kh / 2, sy = kh - 1 - ry;
+    const uint8_t *in = src->pData;
+    uint8_t *out = dst->pData;
+
+    // Bradley: p * N * 100 > S * (100 - t)
+    const uint32_t brad = (p1 > 100) ? 0u : 100u - p1;
+    // Sauvola: T = m * (1 + k * (s / R - 1))
+    const float k = (float)p1 * 0.01f;
+    const float kR = (p2 != 0) ? k / (float)p2 : 0.0f;
+
+    memset(_ad_col, 0, (size_t)w * sizeof(_ad_col[0]));
+    memset(_ad_colsq, 0, (size_t)w * sizeof(_ad_colsq[0]));
+    for (int y = 0; y <= sy && y < h; y++) _ad_add_row(in + (uint32_t)y * w, w, 0);
+
+    for (int y = 0; y < h; y++)
+    {
+        if (y > 0)
+        {
+            if (y + sy < h)       _ad_add_row(in + (uint32_t)(y + sy) * w, w, 0);
+            if (y - ry - 1 >= 0)  _ad_add_row(in + (uint32_t)(y - ry - 1) * w, w, 1);
+        }
+        const uint32_t ny = (uint32_t)((y + sy < h ? y + sy : h - 1) - (y - ry > 0 ? y - ry : 0) + 1);
+
+        uint32_t S = 0;
+        uint64_t Q = 0;
+        for (int x = 0; x <= sx && x < w; x++) { S += _ad_col[x]; Q += _ad_colsq[x]; }
+
+        const uint8_t *pi = in + (uint32_t)y * w;
+        uint8_t *po = out + (uint32_t)y * w;
+        uint32_t lastN = 0;
+        float invN = 0.0f;
+
+        for (int x = 0; x < w; x++)
+        {
+            if (x > 0)
+            {
+                if (x + sx < w)      { S += _ad_col[x + sx];      Q += _ad_colsq[x + sx]; }
+                if (x - rx - 1 >= 0) { S -= _ad_col[x - rx - 1];  Q -= _ad_colsq[x - rx - 1]; }
+            }
+            const uint32_t nx = (uint32_t)((x + sx < w ? x + sx : w - 1) - (x - rx > 0 ? x - rx : 0) + 1);
+            const uint32_t N = nx * ny;
+
+            if (!sauvola)
+            {
+                po[x] = ((uint64_t)pi[x] * N * 100u > (uint64_t)S * brad) ? 255 : 0;
+                continue;
+            }
+
+            // N yalnızca kenarlarda değişir, bölme iç bölgede tekrarlanmaz
+            if (N != lastN) { lastN = N; invN = 1.0f / (float)N; }
+
+            // N*Q - S^2 tamsayıda tam, float yalnızca karekök için
+            const uint64_t V = (uint64_t)N * Q - (uint64_t)S * S;
+            const float m  = (float)S * invN;
+            const float sd = sqrtf((float)V) * invN;
+            const float T  = m * (1.0f - k + kR * sd);
+
+            po[x] = ((float)pi[x] > T) ? 255 : 0;
+        }
+    }
+
+    return IMAGE_OK;
+}
+
+/**
+  * @brief  Bradley adaptive threshold: a pixel is foreground (255) when it is
+  *         brighter than (100 - t_pct)% of the mean of its kw x kh window.
+  * @note   GRAYSCALE only, src and dst must not share a buffer. Window is
+  *         clipped at the frame edges. Typical t_pct: 10..20.
+  */
+int8_t IMAGE_ThresholdBradley(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst,
+                              uint16_t kw, uint16_t kh, uint8_t t_pct)
+{
+    return _adaptive_thresh(src, dst, kw, kh, 0, t_pct, 0);
+}
+
+/**
+  * @brief  Sauvola adaptive threshold: T = m * (1 + k * (s / R - 1)) with m, s
+  *         the mean and standard deviation of the kw x kh window, k = k_pct/100.
+  * @note   GRAYSCALE only, src and dst must not share a buffer. Typical
+  *         k_pct = 34, range = 128.
+  */
+int8_t IMAGE_ThresholdSauvola(const IMAGE_HandleTypeDef *src, IMAGE_HandleTypeDef *dst,
+                              uint16_t kw, uint16_t kh, uint8_t k_pct, uint8_t range)
+{
+    if (range == 0) return IMAGE_ERROR;
+    return _adaptive_thresh(src, dst, kw, kh, 1, k_pct, range);
+}
+
+/* ---------------------------------------------------------------------------
+ * RGB565 yerel derinlik tabloları: 5/6 bitlik alan -> 8 bit genişletme
+ * ((v*255 + 15)/31, (v*255 + 31)/63) ve gri ağırlıklı kısmi toplamlar
+ * (30*R8, 59*G8, 11*B8). Gri = toplam/100 olduğundan "gri > T" koşulu
+ * toplam >= 100*(T+1) olur; piksel başına üç tablo okuması, bölme yok.
+ * ------------------------------------------------------------------------- */
+
+static const uint8_t _rgb5_to8[32] = {
+    0, 8, 16, 25, 33, 41, 49, 58, 66, 74, 82, 90, 99, 107, 115, 123,
+    132, 140, 148, 156, 165, 173, 181, 189, 197, 206, 214, 222, 230, 239, 247, 255,
+};
+static const uint8_t _rgb6_to8[64] = {
+    0, 4, 8, 12, 16, 20, 24, 28, 32, 36, 40, 45, 49, 53, 57, 61,
+    65, 69, 73, 77, 81, 85, 89, 93, 97, 101, 105, 109, 113, 117, 121, 125,
+    130, 134, 138, 142, 146, 150, 154, 158, 162, 166, 170, 174, 178, 182, 186, 190,
+    194, 198, 202, 206, 210, 215, 219, 223, 227, 231, 235, 239, 243, 247, 251, 255,
+};
+
+static const uint16_t _gray_r5[32] = {
+    0, 240, 480, 750, 990, 1230, 1470, 1740, 1980, 2220, 2460, 2700, 2970, 3210, 3450, 3690,
+    3960, 4200, 4440, 4680, 4950, 5190, 5430, 5670, 5910, 6180, 6420, 6660, 6900, 7170, 7410, 7650,
+};
+static const uint16_t _gray_g6[64] = {
+    0, 236, 472, 708, 944, 1180, 1416, 1652, 1888, 2124, 2360, 2655, 2891, 3127, 3363, 3599,
+    3835, 4071, 4307, 4543, 4779, 5015, 5251, 5487, 5723, 5959, 6195, 6431, 6667, 6903, 7139, 7375,
+    7670, 7906, 8142, 8378, 8614, 8850, 9086, 9322, 9558, 9794, 10030, 10266, 10502, 10738, 10974, 11210,
+    11446, 11682, 11918, 12154, 12390, 12685, 12921, 13157, 13393, 13629, 13865, 14101, 14337, 14573, 14809, 15045,
+};
+static const uint16_t _gray_b5[32] = {
+    0, 88, 176, 275, 363, 451, 539, 638, 726, 814, 902, 990, 1089, 1177, 1265, 1353,
+    1452, 1540, 1628, 1716, 1815, 1903, 1991, 2079, 2167, 2266, 2354, 2442, 2530, 2629, 2717, 2805,
+};
+
+static inline uint16_t _rgb565_gray100(const uint8_t *p)
+{
+    const uint16_t pix = (uint16_t)p[0] | ((uint16_t)p[1] << 8);
+    return (uint16_t)(_gray_r5[pix >> 11] + _gray_g6[(pix >> 5) & 0x3F] + _gray_b5[pix & 0x1F]);
+}
+
+/* ---------------------------------------------------------------------------
+ * RGB888: piksel başına 3 bayt, PC tarafındaki OpenCV sırasıyla B, G, R.
+ * Dört piksel = üç 32-bit kelime; ayrıştırma ve sayım kelime kelime yapılır,
+ * 3 adımlı bayt erişimi yalnızca satır sonu artığında kalır. Düzlemsel
+ * (planar) dönüşüm her kanalı ardışık bir bayt düzlemine ayırır; böylece gri
+ * seviye çekirdekler (IMAGE_Histogram, IMAGE_GrayDilate, ...) her düzlemde
+ * GRAYSCALE handle ile doğrudan çalışır.
+ * ------------------------------------------------------------------------- */
+
+#define _RGB888_B	0
+#define _RGB888_G	1
+#define _RGB888_R	2
+
+static inline uint32_t _rgb888_gray100(const uint8_t *p)
+{
+    return 30u * p[_RGB888_R] + 59u * p[_RGB888_G] + 11u * p[_RGB888_B];
+}
+
+/**
+  * @brief  Split an RGB888 image into three contiguous byte planes
+  *         (planes[0..n-1] = byte 0 (B), then byte 1 (G), then byte 2 (R)).
+  * @note   planes must hold src->size bytes and must not overlap src.
+  */
+int8_t IMAGE_RGB888ToPlanar(const IMAGE_HandleTypeDef *src, uint8_t *planes)
+{
+    if (!src || !src->pData || !planes || src->format != IMAGE_FORMAT_RGB888) return IMAGE_ERROR;
+
+    const uint32_t n = (uint32_t)src->width * src->height;
+    const uint8_t *p = src->pData;
+    uint8_t *p0 = planes, *p1 = planes + n, *p2 = planes + 2u * n;
+    uint32_t i = 0;
+
+    // 4 piksel: w0 = b0..b3, w1 = b4..b7, w2 = b8..b11
+    for (; i + 4 <= n; i += 4, p += 12)
+    {
+        uint32_t w0, w1, w2, o;
+        memcpy(&w0, p, 4);
+        memcpy(&w1, p + 4, 4);
+        memcpy(&w2, p + 8, 4);
+
+        o = (w0 & 0xFFu) | ((w0 >> 16) & 0xFF00u) | (w1 & 0xFF0000u) | ((w2 << 16) & 0xFF000000u);
+        memcpy(p0 + i, &o, 4);
+        o = ((w0 >> 8) & 0xFFu) | ((w1 << 8) & 0xFF00u) | ((w1 >> 8) & 0xFF0000u) | ((w2 << 8) & 0xFF000000u);
+        memcpy(p1 + i, &o, 4);
+        o = ((w0 >> 16) & 0xFFu) | (w1 & 0xFF00u) | ((w2 << 16) & 0xFF0000u) | (w2 & 0xFF000000u);
+        memcpy(p2 + i, &o, 4);
+    }
+    for (; i < n; i++, p += 3)
+    {
+        p0[i] = p[0];
+        p1[i] = p[1];
+        p2[i] = p[2];
+    }
+    return IMAGE_OK;
+}
+
+// IMAGE_RGB888ToPlanar'ın tersi; dst RGB888 olmalı, planes ile örtüşmemeli
+int8_t IMAGE_PlanarToRGB888(const uint8_t *planes, IMAGE_HandleTypeDef *dst)
+{
+    if (!dst || !dst->pData || !planes || dst->format != IMAGE_FORMAT_RGB888) return IMAGE_ERROR;
+    _occ_reset(dst);
+
+    const uint32_t n = (uint32_t)dst->width * dst->height;
+    const uint8_t *p0 = planes, *p1 = planes + n, *p2 = planes + 2u * n;
+    uint8_t *p = dst->pData;
+    uint32_t i = 0;
+
+    for (; i + 4 <= n; i += 4, p += 12)
+    {
+        uint32_t c0, c1, c2, w;
+        memcpy(&c0, p0 + i, 4);
+        memcpy(&c1, p1 + i, 4);
+        memcpy(&c2, p2 + i, 4);
+
+        w = (c0 & 0xFFu) | ((c1 & 0xFFu) << 8) | ((c2 & 0xFFu) << 16) | ((c0 & 0xFF00u) << 16);
+        memcpy(p, &w, 4);
+        w = ((c1 >> 8) & 0xFFu) | (c2 & 0xFF00u) | (c0 & 0xFF0000u) | ((c1 & 0xFF0000u) << 8);
+        memcpy(p + 4, &w, 4);
+        w = ((c2 >> 16) & 0xFFu) | ((c0 >> 16) & 0xFF00u) | ((c1 >> 8) & 0xFF0000u) | (c2 & 0xFF000000u);
+        memcpy(p + 8, &w, 4);
+    }
+    for (; i < n; i++, p += 3)
+    {
+        p[0] = p0[i];
+        p[1] = p1[i];
+        p[2] = p2[i];
+    }
+    return IMAGE_OK;
+}
+
+/**
+  * @brief  Per-channel 256-bin histograms of an RGB888 image in one pass,
+  *         reading three 32-bit words per four pixels.
+  */
+int8_t IMAGE_HistogramRGB888(const IMAGE_HandleTypeDef *img, uint32_t histB[256], uint32_t histG[256], uint32_t histR[256])
+{
+    if (!img || !img->pData || !histB || !histG || !histR) return IMAGE_ERROR;
+    if (img->format != IMAGE_FORMAT_RGB888) return IMAGE_ERROR;
+
+    memset(histB, 0, 256u * sizeof(uint32_t));
+    memset(histG, 0, 256u * sizeof(uint32_t));
+    memset(histR, 0, 256u * sizeof(uint32_t));
+
+    // h[k] = bayt konumu k mod 3 olan kanal
+    uint32_t *h[3];
+    h[_RGB888_B] = histB;
+    h[_RGB888_G] = histG;
+    h[_RGB888_R] = histR;
+
+    const uint32_t n = (uint32_t)img->width * img->height;
+    const uint8_t *p = img->pData;
+    uint32_t i = 0;
+
+    for (; i + 4 <= n; i += 4, p += 12)
+    {
+        uint32_t w0, w1, w2;
+        memcpy(&w0, p, 4);
+        memcpy(&w1, p + 4, 4);
+        memcpy(&w2, p + 8, 4);
+
+        h[0][w0 & 0xFF]++;  h[1][(w0 >> 8) & 0xFF]++;  h[2][(w0 >> 16) & 0xFF]++; h[0][w0 >> 24]++;
+        h[1][w1 & 0xFF]++;  h[2][(w1 >> 8) & 0xFF]++;  h[0][(w1 >> 16) & 0xFF]++; h[1][w1 >> 24]++;
+        h[2][w2 & 0xFF]++;  h[0][(w2 >> 8) & 0xFF]++;  h[1][(w2 >> 16) & 0xFF]++; h[2][w2 >> 24]++;
+    }
+    for (; i < n; i++, p += 3)
+    {
+        h[0][p[0]]++;
+        h[1][p[1]]++;
+        h[2][p[2]]++;
+    }
+    return IMAGE_OK;
+}
+
 int8_t LIB_IMAGE_InitStruct(IMAGE_HandleTypeDef * img, uint8_t *pImg, uint16_t height, uint16_t width, IMAGE_Format format)
 {
 	__LIB_IMAGE_CHECK_PARAM(img);
@@ -156,13 +3658,26 @@ int8_t LIB_IMAGE_InitStruct(IMAGE_HandleTypeDef * img, uint8_t *pImg, uint16_t h
 	img->height = height;
 	img->width 	= width;
 	img->pData 	= pImg;
-	img->size 	= (uint32_t)img->format * (uint32_t)img->height * (uint32_t)img->width;
+	img->pOcc	= NULL;
+	if (format == IMAGE_FORMAT_BINARY1)
+		img->size = 4u * IMAGE_BINARY1_WORDS(width) * (uint32_t)img->height;
+	else if (format == IMAGE_FORMAT_RLE)
+		img->size = IMAGE_RLE_MAX_SIZE(width, height);
+	else
+		img->size = (uint32_t)img->format * (uint32_t)img->height * (uint32_t)img->width;
 	return IMAGE_OK;
 }
 
 
 
 
+// Hazır bir 256'lık histogramdan Otsu eşiği (ör. alım sırasında doldurulmuş)
+uint8_t IMAGE_OtsuFromHist(const uint32_t hist[256], uint32_t total)
+{
+    if (hist == NULL || total == 0) return 0;
+    return Otsu_FromHist256(hist, total);
+}
+
 uint8_t IMAGE_OtsuThreshold(IMAGE_HandleTypeDef *img)
 {
     if (img == NULL || img->pData == NULL) return 0;
@@ -173,17 +3688,19 @@ uint8_t IMAGE_OtsuThreshold(IMAGE_HandleTypeDef *img)
     // 1️⃣ Grayscale ise: eski davranış
     if (img->format == IMAGE_FORMAT_GRAYSCALE)
     {
-        uint32_t hist[256] = {0};
-
-        for (uint32_t i = 0; i < total; i++)
-            hist[img->pData[i]]++;
+        uint32_t hist[256];
 
+        IMAGE_Histogram(img->pData, img->width, img->height, img->width, NULL, NULL, 0, hist, 0);
         return Otsu_FromHist256(hist, total);
     }
 
     // 2️⃣ RGB565 ise: R,G,B için ayrı histogram
+    // Ham 5/6 bitlik alanlar sayılır, 256'lık histogramlar tablodan açılır
     if (img->format == IMAGE_FORMAT_RGB565)
     {
+        uint32_t h5R[32] = {0};
+        uint32_t h6G[64] = {0};
+        uint32_t h5B[32] = {0};
         uint32_t histR[256] = {0};
         uint32_t histG[256] = {0};
         uint32_t histB[256] = {0};
@@ -194,18 +3711,15 @@ uint8_t IMAGE_OtsuThreshold(IMAGE_HandleTypeDef *img)
         {
             uint16_t pix = (uint16_t)p[0] | ((uint16_t)p[1] << 8);
 
-            uint8_t r5 = (pix >> 11) & 0x1F;
-            uint8_t g6 = (pix >> 5)  & 0x3F;
-            uint8_t b5 =  pix        & 0x1F;
-
-            uint8_t r = (uint8_t)((r5 * 255u + 15u) / 31u);
-            uint8_t g = (uint8_t)((g6 * 255u + 31u) / 63u);
-            uint8_t b = (uint8_t)((b5 * 255u + 15u) / 31u);
-
-            histR[r]++; histG[g]++; histB[b]++;
+            h5R[pix >> 11]++;
+            h6G[(pix >> 5) & 0x3F]++;
+            h5B[pix & 0x1F]++;
             p += 2;
         }
 
+        for (int v = 0; v < 32; v++) { histR[_rgb5_to8[v]] = h5R[v]; histB[_rgb5_to8[v]] = h5B[v]; }
+        for (int v = 0; v < 64; v++) histG[_rgb6_to8[v]] = h6G[v];
+
         uint8_t tR = Otsu_FromHist256(histR, total);
         uint8_t tG = Otsu_FromHist256(histG, total);
         uint8_t tB = Otsu_FromHist256(histB, total);
@@ -217,6 +3731,23 @@ uint8_t IMAGE_OtsuThreshold(IMAGE_HandleTypeDef *img)
         return (uint8_t)t;
     }
 
+    // RGB888: kanallar zaten 8 bit, aynı birleştirme
+    if (img->format == IMAGE_FORMAT_RGB888)
+    {
+        static uint32_t histR[256], histG[256], histB[256];   // 3 KB, stack yerine statik
+
+        IMAGE_HistogramRGB888(img, histB, histG, histR);
+
+        uint8_t tR = Otsu_FromHist256(histR, total);
+        uint8_t tG = Otsu_FromHist256(histG, total);
+        uint8_t tB = Otsu_FromHist256(histB, total);
+
+        uint16_t t = (uint16_t)(30u * tR + 59u * tG + 11u * tB);
+        t = (t + 50u) / 100u;
+
+        return (uint8_t)t;
+    }
+
     return 0;
 }
 
@@ -231,6 +3762,24 @@ void IMAGE_ApplyThreshold(IMAGE_HandleTypeDef *img, uint8_t thresh)
     if (img->format == IMAGE_FORMAT_GRAYSCALE)
     {
         // Gri görüntüde foreground = beyaz, background = siyah
+        if (img->pOcc)
+        {
+            // satır özeti yan ürün olarak
+            uint8_t *p = img->pData;
+            for (uint16_t y = 0; y < img->height; y++)
+            {
+                uint8_t any = 0, all = 255;
+                for (uint16_t x = 0; x < img->width; x++, p++)
+                {
+                    *p = (*p > thresh) ? 255 : 0;
+                    any |= *p;
+                    all &= *p;
+                }
+                img->pOcc[y] = all ? IMAGE_OCC_FULL : (any ? IMAGE_OCC_MIXED : IMAGE_OCC_ZERO);
+            }
+            return;
+        }
+
         for (uint32_t i = 0; i < total; i++)
         {
             img->pData[i] = (img->pData[i] > thresh) ? 255 : 0;
@@ -239,41 +3788,36 @@ void IMAGE_ApplyThreshold(IMAGE_HandleTypeDef *img, uint8_t thresh)
     else if (img->format == IMAGE_FORMAT_RGB565)
     {
         uint8_t *p = img->pData;
+        // gri > thresh  <=>  30R + 59G + 11B >= 100*(thresh+1)
+        const uint16_t lim = (uint16_t)(100u * ((uint32_t)thresh + 1u));
+
+        _occ_reset(img);
 
         for (uint32_t i = 0; i < total; i++)
         {
-            uint16_t pix = (uint16_t)p[0] | ((uint16_t)p[1] << 8);
+            // Foreground = beyaz (0xFFFF), background = siyah (0x0000)
+            const uint8_t v = (_rgb565_gray100(p) >= lim) ? 0xFF : 0x00;
 
-            uint8_t r5 = (pix >> 11) & 0x1F;
-            uint8_t g6 = (pix >> 5)  & 0x3F;
-            uint8_t b5 =  pix        & 0x1F;
-
-            // 8-bit’e ölçekleme
-            uint8_t r = (uint8_t)((r5 * 255u + 15u) / 31u);
-            uint8_t g = (uint8_t)((g6 * 255u + 31u) / 63u);
-            uint8_t b = (uint8_t)((b5 * 255u + 15u) / 31u);
-
-            // Gri hesapla
-            uint8_t gray = (uint8_t)((30u * r + 59u * g + 11u * b) / 100u);
-
-            uint16_t newPix;
+            p[0] = v;
+            p[1] = v;
+            p += 2;
+        }
+    }
+    else if (img->format == IMAGE_FORMAT_RGB888)
+    {
+        uint8_t *p = img->pData;
+        const uint32_t lim = 100u * ((uint32_t)thresh + 1u);
 
-            if (gray <= thresh)
-            {
-                // Background = siyah (0x0000)
-                newPix = 0x0000;
-            }
-            else
-            {
-                // Foreground = beyaz (0xFFFF)
-                newPix = 0xFFFF;
-            }
+        _occ_reset(img);
 
-            // Yaz
-            p[0] = (uint8_t)(newPix & 0xFF);
-            p[1] = (uint8_t)((newPix >> 8) & 0xFF);
+        for (uint32_t i = 0; i < total; i++)
+        {
+            const uint8_t v = (_rgb888_gray100(p) >= lim) ? 0xFF : 0x00;
 
-            p += 2;
+            p[0] = v;
+            p[1] = v;
+            p[2] = v;
+            p += 3;
         }
     }
 }
@@ -2,6 +2,7 @@
  * lib_serialimage.c
  */
 
+#include <string.h>
 #include "lib_serialimage.h"
 
 int8_t LIB_SERIAL_IMG_Transmit(IMAGE_HandleTypeDef * img)
@@ -40,6 +41,13 @@ int8_t LIB_SERIAL_IMG_Receive(IMAGE_HandleTypeDef * img)
 	uint16_t divisor = UINT16_MAX;
 	uint8_t * __pData = img->pData;
 
+	/* RLE uzunluğu içeriğe bağlı, MCU bu formatı yalnızca gönderir */
+	if (img->format == IMAGE_FORMAT_RLE)
+	{
+		return SERIAL_ERROR;
+	}
+	IMAGE_InvalidateOccupancy(img);
+
 	__quotient 	= img->size / divisor;
 	__remainder = img->size % divisor;
 
@@ -66,6 +74,67 @@ int8_t LIB_SERIAL_IMG_Receive(IMAGE_HandleTypeDef * img)
 	return SERIAL_OK;
 }
 
+/*
+ * Grayscale frame'i DMA ile alır; DMA'nın kalan sayacı (NDTR) izlenerek
+ * inen her bayt hemen histograma eklenir. Son bayt geldiğinde hist hazırdır,
+ * IMAGE_OtsuFromHist için ayrı bir geçiş gerekmez.
+ */
+int8_t LIB_SERIAL_IMG_ReceiveHist(IMAGE_HandleTypeDef * img, uint32_t hist[256])
+{
+	uint8_t __header[3] = "STR";
+	uint32_t __done = 0, __end = 0, __tick = 0;
+	volatile const uint8_t * __pData = img->pData;
+
+	if (img->format != IMAGE_FORMAT_GRAYSCALE || __huart.hdmarx == NULL)
+	{
+		return SERIAL_ERROR;
+	}
+	memset(hist, 0, 256u * sizeof(uint32_t));
+	IMAGE_InvalidateOccupancy(img);
+
+	HAL_UART_Transmit(&__huart, __header, 3, 10);
+	HAL_UART_Transmit(&__huart, (uint8_t*)&img->height, 2, 10);
+	HAL_UART_Transmit(&__huart, (uint8_t*)&img->width,  2, 10);
+	HAL_UART_Transmit(&__huart, (uint8_t*)&img->format, 1, 10);
+	while (__done < img->size)
+	{
+		uint16_t __len = (img->size - __done > UINT16_MAX) ? UINT16_MAX : (uint16_t)(img->size - __done);
+
+		__end = __done + __len;
+		if (HAL_UART_Receive_DMA(&__huart, img->pData + __done, __len) != HAL_OK)
+		{
+			return SERIAL_ERROR;
+		}
+		__tick = HAL_GetTick();
+		while (__done < __end)
+		{
+			uint32_t __landed = __end - __HAL_DMA_GET_COUNTER(__huart.hdmarx);
+
+			/* bankalı motorun birleştirme maliyeti için en az 256 bayt biriktir */
+			if (__landed - __done >= 256u || __landed == __end)
+			{
+				IMAGE_Histogram((const uint8_t *)&__pData[__done], (uint16_t)(__landed - __done), 1,
+								__landed - __done, NULL, NULL, 0, hist, 1);
+				__done = __landed;
+			}
+			if (HAL_GetTick() - __tick > 10000)
+			{
+				HAL_UART_AbortReceive(&__huart);
+				return SERIAL_ERROR;
+			}
+		}
+		/* transfer-complete kesmesi UART'ı READY'e çeker */
+		while (__huart.RxState != HAL_UART_STATE_READY)
+		{
+			if (HAL_GetTick() - __tick > 10000)
+			{
+				HAL_UART_AbortReceive(&__huart);
+				return SERIAL_ERROR;
+			}
+		}
+	}
+	return SERIAL_OK;
+}
 
 //
 //void LIB_SERIAL_ImageCapture(IMAGE_HandleTypeDef * img)
@@ -25,6 +25,7 @@
 
 /* Private variables ---------------------------------------------------------*/
 UART_HandleTypeDef huart2;
+DMA_HandleTypeDef hdma_usart2_rx;
 
 /* USER CODE BEGIN PV */
 
@@ -35,6 +36,7 @@ UART_HandleTypeDef huart2;
 /* Private function prototypes -----------------------------------------------*/
 void SystemClock_Config(void);
 static void MX_GPIO_Init(void);
+static void MX_DMA_Init(void);
 static void MX_USART2_UART_Init(void);
 /* USER CODE BEGIN PFP */
 
@@ -45,12 +47,13 @@ static void MX_USART2_UART_Init(void);
 // 128x128 çözünürlük, RGB565 (2 byte) , grayscale de 1
 
 
+// Tüm zincir (Otsu -> eşik -> morfoloji) tek frame buffer üzerinde yerinde çalışır
 volatile uint8_t pImage[128*128*1];
-volatile uint8_t pOut[128*128*1];
-volatile uint8_t pScratch[128*128*1];   // opening/closing ara buffer
+// Satır doluluk özeti: eşikleme yazar, 3x3 morfoloji tekdüze satırları atlar
+uint8_t imgOcc[128];
+uint32_t imgHist[256];
 
 IMAGE_HandleTypeDef img;
-IMAGE_HandleTypeDef out;
 
 /* USER CODE END 0 */
 
@@ -83,11 +86,12 @@ int main(void)
 
   /* Initialize all configured peripherals */
   MX_GPIO_Init();
+  MX_DMA_Init();
   MX_USART2_UART_Init();
   /* USER CODE BEGIN 2 */
   // Görüntü yapısını 128x128 olarak başlat
   LIB_IMAGE_InitStruct(&img, (uint8_t*)pImage, 128, 128, 1);
-  LIB_IMAGE_InitStruct(&out, (uint8_t*)pOut,   128, 128, 1);
+  IMAGE_AttachOccupancy(&img, imgOcc);
 
   /* USER CODE END 2 */
 
@@ -101,23 +105,24 @@ int main(void)
 	  while (1)
 	  {
 
-	      if (LIB_SERIAL_IMG_Receive(&img) == SERIAL_OK)
+	      // Histogram, DMA frame'i yazarken doldurulur; Otsu son bayttan hemen sonra hazır
+	      if (LIB_SERIAL_IMG_ReceiveHist(&img, imgHist) == SERIAL_OK)
 	      {
 
-	          uint8_t th = IMAGE_OtsuThreshold(&img);
+	          uint8_t th = IMAGE_OtsuFromHist(imgHist, img.size);
 
 
 	          IMAGE_ApplyThreshold(&img, th);
 	          // img.pData artık 0 / 255 binary
 
 	          // 1) Dilation
-	          IMAGE_Dilate3x3(&img, &out);  LIB_SERIAL_IMG_Transmit(&out);
+	          IMAGE_Dilate3x3(&img, &img);  LIB_SERIAL_IMG_Transmit(&img);
 
-	          // 2) Erosion  IMAGE_Erode3x3(&img, &out);   LIB_SERIAL_IMG_Transmit(&out);
+	          // 2) Erosion  IMAGE_Erode3x3(&img, &img);   LIB_SERIAL_IMG_Transmit(&img);
 
-	          // 3) Opening   IMAGE_Opening3x3(&img, &out, (uint8_t*)pScratch);  LIB_SERIAL_IMG_Transmit(&out);
+	          // 3) Opening   IMAGE_OpeningStream3x3(&img, &img);  LIB_SERIAL_IMG_Transmit(&img);
 
-	          // 4) Closing   IMAGE_Closing3x3(&img, &out, (uint8_t*)pScratch); LIB_SERIAL_IMG_Transmit(&out);
+	          // 4) Closing   IMAGE_ClosingStream3x3(&img, &img); LIB_SERIAL_IMG_Transmit(&img);
 	      }
 	  }
 
@@ -205,6 +210,22 @@ static void MX_USART2_UART_Init(void)
 
 }
 
+/**
+  * Enable DMA controller clock
+  */
+static void MX_DMA_Init(void)
+{
+
+  /* DMA controller clock enable */
+  __HAL_RCC_DMA1_CLK_ENABLE();
+
+  /* DMA interrupt init */
+  /* DMA1_Stream5_IRQn interrupt configuration */
+  HAL_NVIC_SetPriority(DMA1_Stream5_IRQn, 0, 0);
+  HAL_NVIC_EnableIRQ(DMA1_Stream5_IRQn);
+
+}
+
 /**
   * @brief GPIO Initialization Function
   * @param None
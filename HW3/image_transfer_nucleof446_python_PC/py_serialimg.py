@@ -10,11 +10,19 @@ MCU_READS  = 82
 rqType = { MCU_WRITES: "MCU Sends Image", MCU_READS: "PC Sends Image"} 
 
 # Format 
-formatType = { 1: "Grayscale", 2: "RGB565", 3: "RGB888",} 
+formatType = { 1: "Grayscale", 2: "RGB565", 3: "RGB888", 4: "Binary1", 5: "RLE",} 
 
 IMAGE_FORMAT_GRAYSCALE	= 1
 IMAGE_FORMAT_RGB565		= 2
 IMAGE_FORMAT_RGB888		= 3
+IMAGE_FORMAT_BINARY1	= 4
+IMAGE_FORMAT_RLE		= 5
+
+# BINARY1: 1 bit/piksel, her satir 32-bit kelimelere tamamlanir, LSB = sol piksel
+def IMAGE_Size(height, width, format):
+    if format == IMAGE_FORMAT_BINARY1:
+        return height * ((width + 31) // 32) * 4
+    return height * width * format
 
 # Init Com Port
 def SERIAL_Init(port):
@@ -41,7 +49,7 @@ def SERIAL_IMG_PollForRequest():
                 height       = int(np.frombuffer(__serial.read(2), dtype= np.uint16))
                 width        = int(np.frombuffer(__serial.read(2), dtype= np.uint16))
                 format       = int(np.frombuffer(__serial.read(1), dtype= np.uint8))
-                imgSize     = height * width * format
+                imgSize     = IMAGE_Size(height, width, format)
                 
                 print("Request Type : ", rqType[int(requestType)])
                 print("Height       : ", int(height))
@@ -50,10 +58,30 @@ def SERIAL_IMG_PollForRequest():
                 print()
                 return [int(requestType), int(height), int(width), int(format)]
 
+# RLE: her satir uint16 kosu sayisi n + n adet (x0, x1) uint16, uzunluk icerige bagli
+def SERIAL_IMG_ReadRLE():
+    img = np.zeros((height, width), dtype = np.uint8)
+    for y in range(height):
+        n    = int(np.frombuffer(__serial.read(2), dtype= np.uint16)[0])
+        runs = np.frombuffer(__serial.read(4 * n), dtype= np.uint16)
+        for x0, x1 in runs.reshape(-1, 2):
+            img[y, x0:x1 + 1] = 255
+    return img
+
 # Reads Image from MCU  
 def SERIAL_IMG_Read():
-    img = np.frombuffer(__serial.read(imgSize), dtype = np.uint8)
-    img = np.reshape(img, (height, width, format))
+    if format == IMAGE_FORMAT_RLE:
+        img = SERIAL_IMG_ReadRLE()
+    else:
+        img = np.frombuffer(__serial.read(imgSize), dtype = np.uint8)
+    if format == IMAGE_FORMAT_RLE:
+        img = cv2.cvtColor(img, cv2.COLOR_GRAY2BGR)
+    elif format == IMAGE_FORMAT_BINARY1:
+        img = np.reshape(img, (height, -1))
+        img = np.unpackbits(img, axis = 1, bitorder = 'little')[:, :width] * 255
+        img = cv2.cvtColor(img, cv2.COLOR_GRAY2BGR)
+    else:
+        img = np.reshape(img, (height, width, format))
     if format == IMAGE_FORMAT_GRAYSCALE:
         img = cv2.cvtColor(img, cv2.COLOR_GRAY2BGR)
     elif format == IMAGE_FORMAT_RGB565: